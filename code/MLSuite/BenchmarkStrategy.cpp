@@ -14,13 +14,25 @@ BenchmarkResult BenchmarkStrategy::trainAndExecute(IModel& model, const Dataset&
 
 	std::cout << "\n--- Benchmarking " << model.getName() << " ---" << std::endl;
     	const auto start = std::chrono::high_resolution_clock::now();
-    	model.fit(trainFeatures.get_data(), trainFeatures.get_columns(), trainTargets.get_data());
+    	model.fitView(trainFeatures.view(), trainTargets.values());
     	const auto end = std::chrono::high_resolution_clock::now();
     
     	double fitMillis = millisBetween(start, end);
     	return execute(model, testFeatures, testTargets, fitMillis);
 }
 
+PrecisionComparison BenchmarkStrategy::comparePrecision(IModel& float32Model, IModel& float64Model, const Dataset& trainFeatures,
+							const Dataset& trainTargets, const Dataset& testFeatures, const Dataset& testTargets) const {
+	PrecisionComparison comparison;
+    	comparison.float32 = trainAndExecute(float32Model, trainFeatures, trainTargets, testFeatures, testTargets);
+    	comparison.float64 = trainAndExecute(float64Model, trainFeatures, trainTargets, testFeatures, testTargets);
+    	comparison.scoreDifference = evaluate(float32Model, testFeatures, testTargets) - evaluate(float64Model, testFeatures, testTargets);
+
+    	std::cout << "float32 - float64 score difference (" << float32Model.getName() << "): " << comparison.scoreDifference
+    		  << ", fit " << comparison.float32.fitMillis << " ms vs " << comparison.float64.fitMillis << " ms" << std::endl;
+    	return comparison;
+}
+
 double currentMemoryUsageBytes() {
 #ifdef _WIN32
     PROCESS_MEMORY_COUNTERS pmc;
@@ -38,3 +50,7 @@ double currentMemoryUsageBytes() {
 double millisBetween(const std::chrono::high_resolution_clock::time_point& start, const std::chrono::high_resolution_clock::time_point& end) {
 	return std::chrono::duration<double, std::milli>(end - start).count();
 }
+
+double rowsPerSecond(std::size_t rows, double millis) {
+	return millis > 0.0 ? static_cast<double>(rows) * 1000.0 / millis : 0.0;
+}
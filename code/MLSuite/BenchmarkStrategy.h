@@ -7,6 +7,8 @@
 #include <chrono>
 #include "IModel.h"
 #include "Dataset.h"
+#include "DatasetStream.h"
+#include "MatrixView.h"
 
 struct BenchmarkResult {
 	std::string modelName;
@@ -14,6 +16,8 @@ struct BenchmarkResult {
     	std::size_t numSamples{0};
     	double fitMillis{0.0};
     	double predictMillis{0.0};
+    	int predictThreads{1};
+    	double predictRowsPerSec{0.0}; // batch predict throughput
     	std::size_t memoryBytes{0};    // current RSS snapshots, working set 
 
     	// Regression metrics
@@ -28,22 +32,40 @@ struct BenchmarkResult {
     	double f1{std::numeric_limits<double>::quiet_NaN()};
 };
 
+// the float32 and float64 builds of one model (e.g. RandomForest and RandomForest64) trained and tested on the same data
+struct PrecisionComparison {
+	BenchmarkResult float32;
+	BenchmarkResult float64;
+	double scoreDifference{0.0}; // evaluate() of the float32 model minus that of the float64 model, lower is better
+};
+
 // benchmark strategy, impls return a filled BenchmarkResult
 class BenchmarkStrategy {
 public:
 	virtual ~BenchmarkStrategy() = default;
     	virtual BenchmarkResult execute(const IModel& model, const Dataset& xData, const Dataset& yData, double fitMillis = 0.0) const = 0;
 
+    	// same metrics over streamed feature/target batches through predictInto, only one batch of predictions is kept
+    	virtual BenchmarkResult executeStream(const IModel& model, DatasetStream& xStream, DatasetStream& yStream, double fitMillis = 0.0) const = 0;
+
     	// MSE for regression, 1 - accuracy for classif 
     	virtual double evaluate(const IModel& model, const Dataset& features, const Dataset& targets) const = 0;
 
+    	// the evaluate() metric of predictions already made, e.g. validation scores a booster updates once per round
+    	virtual double evaluatePredictions(Span<const float> predictions, Span<const float> targets) const = 0;
+
     	// train, time and execute 
     	BenchmarkResult trainAndExecute(IModel& model, const Dataset& trainFeatures, const Dataset& trainTargets, const Dataset& testFeatures, 
 				     const Dataset& testTargets) const;
+
+    	// trainAndExecute for both models, then prints how much accuracy float32 gives up
+    	PrecisionComparison comparePrecision(IModel& float32Model, IModel& float64Model, const Dataset& trainFeatures, const Dataset& trainTargets,
+					     const Dataset& testFeatures, const Dataset& testTargets) const;
 };
 
 // shared helpers for timing and memory snapshots
 double currentMemoryUsageBytes();
 double millisBetween(const std::chrono::high_resolution_clock::time_point& start, const std::chrono::high_resolution_clock::time_point& end);
+double rowsPerSecond(std::size_t rows, double millis);
 
 #endif
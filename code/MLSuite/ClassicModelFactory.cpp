@@ -3,6 +3,7 @@
 #include "LinearRegressionBuilder.h" 
 #include "XGBoostBuilder.h"
 #include "LogisticRegressionBuilder.h" 
+#include "FeatureMatrix.h"
 #include <Eigen/Dense> 
 #include <limits>
 #include <random>
@@ -125,21 +126,22 @@ Dataset ClassicModelFactory::loadTestTargets() const {
 void ClassicModelFactory::fitModel(IModel& model) const {
 	Dataset features = loadTrainFeatures();
 	Dataset targets = loadTrainTargets();
-	model.fit(features.get_data(), features.get_columns(), targets.get_data());
+	// read in place, a binary training set through its mapped columns
+	model.fitView(features.view(), targets.values());
 }
 
 
 
-// Implementation of HyperparameterSearch::randomSearch
+// Implementation of HyperparameterSearch::randomSearch over a row-major view
 std::unique_ptr<IModel> ClassicModelFactory::randomSearch(
 	const std::string& modelType,
     	const std::vector<std::vector<std::string>>& hyperParams,
-    	const std::vector<std::vector<double>>& X,
-    	const std::vector<double>& y,
+    	const MatrixView& X,
+    	Span<const float> y,
     	const BenchmarkStrategy& evaluationStrategy,
         const LogFn& log) {
 
-	if (X.empty() || y.empty() || X.size() != y.size()) {
+	if (X.empty() || y.size == 0 || X.rows != y.size) {
 		throw std::invalid_argument("randomSearch: X and y must be non-empty and have matching sizes.");
 	}
 
@@ -159,7 +161,7 @@ std::unique_ptr<IModel> ClassicModelFactory::randomSearch(
     log("Starting random search for " + modelType + " with " + std::to_string(maxIterations) + " iterations and " + std::to_string(kFolds) + "-fold CV.");
 
     	// Prepare shuffled indices for K-Fold Cross Validation
-    	std::vector<size_t> indices(X.size());
+    	std::vector<size_t> indices(X.rows);
     	std::iota(indices.begin(), indices.end(), 0);
     	std::shuffle(indices.begin(), indices.end(), rng);
 
@@ -181,20 +183,45 @@ std::unique_ptr<IModel> ClassicModelFactory::randomSearch(
 
     	bool foundAny = false;
 
-	// helper function for float to double & double to float conversions 
-    	auto doubleToFloat1D = [](const std::vector<double>& v) {
-         	return std::vector<float>(v.begin(), v.end());
-    	};
+	// fold buffers are refilled in place for every fold: training rows go to the models as a borrowed FeatureMatrix,
+	// validation rows are moved into Datasets for the evaluation strategy and taken back afterwards
+	const size_t nCols = X.cols;
+	std::vector<std::string> columnNames;
+	columnNames.reserve(nCols);
+	for (size_t j = 0; j < nCols; ++j) {
+		columnNames.push_back(std::to_string(j));
+	}
 
-    	auto doubleToFloat2D = [](const std::vector<std::vector<double>>& v) {
-        	std::vector<std::vector<float>> out;
-        	out.reserve(v.size());
-        	for(const auto& row : v) {
-            		out.emplace_back(row.begin(), row.end());
-        	}
+	std::vector<float> trainX, trainY, valX, valY;
+	trainX.reserve(X.rows * nCols);
+	trainY.reserve(X.rows);
+
+	auto splitFold = [&](int k) {
+		trainX.clear();
+		trainY.clear();
+		valX.clear();
+		valY.clear();
+
+		size_t foldSize = X.rows / kFolds;
+		size_t start = k * foldSize;
+		size_t end = (k == kFolds - 1) ? X.rows : start + foldSize;
+
+		for (size_t i = 0; i < X.rows; ++i) {
+			const bool validation = i >= start && i < end;
+			std::vector<float>& rowsOut = validation ? valX : trainX;
+			for (size_t j = 0; j < nCols; ++j) rowsOut.push_back(X(indices[i], j)); // X may be column-major
+			(validation ? valY : trainY).push_back(y[indices[i]]);
+		}
+	};
 
-        	return out;
-    	};
+	auto scoreFold = [&](const IModel& model) {
+		Dataset valXData(std::move(valX), columnNames);
+		Dataset valYData(std::move(valY), {"target"});
+		double score = evaluationStrategy.evaluate(model, valXData, valYData);
+		valX = valXData.take_data();
+		valY = valYData.take_data();
+		return score;
+	};
 
 	if (modelType == "RandomForest") {
 		// Expected order:
@@ -223,38 +250,12 @@ std::unique_ptr<IModel> ClassicModelFactory::randomSearch(
 
             	// K-Fold Loop
             	for (int k = 0; k < kFolds; ++k) {
-                	std::vector<std::vector<double>> trainX, valX;
-                	std::vector<double> trainY, valY;
-                
-                	// Reserve memory to avoid reallocations
-                	trainX.reserve(X.size()); 
-                	valX.reserve(X.size() / kFolds + 2);
-                	trainY.reserve(y.size()); 
-                	valY.reserve(y.size() / kFolds + 2);
-
-                	size_t foldSize = X.size() / kFolds;
-                	size_t start = k * foldSize;
-                	size_t end = (k == kFolds - 1) ? X.size() : start + foldSize;
-
-                	for (size_t i = 0; i < X.size(); ++i) {
-                    		if (i >= start && i < end) {
-                        		valX.push_back(X[indices[i]]);
-                        		valY.push_back(y[indices[i]]);
-                    		} else {
-                        		trainX.push_back(X[indices[i]]);
-                        		trainY.push_back(y[indices[i]]);
-                    		}
-                	}
+                	splitFold(k);
 
                 	auto rf = RandomForestBuilder().setEstimators(nEstimators).setMaxDepth(maxDepth).setMinSamplesSplit(minSamplesSplit).build();
 
-                	rf->fit(trainX, trainY);
-                
-			// make a Dataset for eval 
-                	Dataset valXData(doubleToFloat2D(valX), {});
-                	Dataset valYData({}, doubleToFloat1D(valY));
-
-                	totalScore += evaluationStrategy.evaluate(*rf, valXData, valYData);
+                	rf->fit(FeatureMatrix(trainX, nCols), trainY);
+                	totalScore += scoreFold(*rf);
             	}
 
             		double avgScore = totalScore / kFolds;
@@ -280,7 +281,7 @@ std::unique_ptr<IModel> ClassicModelFactory::randomSearch(
 				.setMinSamplesSplit(bestRF_minSamplesSplit)
                 		.build();
 
-            		finalRf->fit(X, y);
+            		finalRf->fit(FeatureMatrix(X), y);
             		bestModel = std::move(finalRf);
         	}
 
@@ -320,40 +321,15 @@ std::unique_ptr<IModel> ClassicModelFactory::randomSearch(
 
             // K-Fold Loop
             for (int k = 0; k < kFolds; ++k) {
-		std::vector<std::vector<double>> trainX, valX;
-                std::vector<double> trainY, valY;
-
-                trainX.reserve(X.size()); 
-                valX.reserve(X.size() / kFolds + 2);
-                trainY.reserve(y.size()); 
-                valY.reserve(y.size() / kFolds + 2);
-
-                size_t foldSize = X.size() / kFolds;
-                size_t start = k * foldSize;
-                size_t end = (k == kFolds - 1) ? X.size() : start + foldSize;
-
-                for (size_t i = 0; i < X.size(); ++i) {
-			if (i >= start && i < end) {
-                        	valX.push_back(X[indices[i]]);
-                        	valY.push_back(y[indices[i]]);
-                    	} else {
-                        	trainX.push_back(X[indices[i]]);
-                        	trainY.push_back(y[indices[i]]);
-                    	}
-                }
+                splitFold(k);
 
                 auto xgb = XGBoostBuilder().setNEstimators(nEstimators).setLearningRate(learningRate).setMaxDepth(maxDepth).setSubsampleRatio(subsampleRatio)
                     .setGamma(gamma)
                     .setRegularization(regularization)
                     .build();
 
-                xgb->fit(trainX, trainY);
-                
-                // Construct datasets for evaluation
-                Dataset valXData(doubleToFloat2D(valX), {});
-                Dataset valYData({}, doubleToFloat1D(valY));
-
-                totalScore += evaluationStrategy.evaluate(*xgb, valXData, valYData);
+                xgb->fit(FeatureMatrix(trainX, nCols), trainY);
+                totalScore += scoreFold(*xgb);
             }
 
             	double avgScore = totalScore / kFolds;
@@ -383,7 +359,7 @@ std::unique_ptr<IModel> ClassicModelFactory::randomSearch(
                 	.setRegularization(bestXGB_regularization)
                 	.build();
 
-            		finalXgb->fit(X, y);
+            		finalXgb->fit(FeatureMatrix(X), y);
             		bestModel = std::move(finalXgb);
         	}
 	}
@@ -38,13 +38,14 @@ public:
 
 	void fitModel(IModel& model) const;
 
+	using HyperparameterSearch::randomSearch;
 	std::unique_ptr<IModel> randomSearch(
 		const std::string& modelType,
         const std::vector<std::vector<std::string>>& hyperParams,
-        const std::vector<std::vector<double>>& X,
-        const std::vector<double>& y,
+        const MatrixView& X,
+        Span<const float> y,
         const BenchmarkStrategy& evaluationStrategy,
-        const LogFn& log) override;
+        const LogFn& log = [](const std::string&) {}) override;
 
 	std::unique_ptr<IModel> createLinRegModel(); // linreg 
 	std::unique_ptr<IModel> createLogRegModel();
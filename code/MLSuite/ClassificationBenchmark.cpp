@@ -45,32 +45,67 @@ double computeAccuracy(const std::vector<int>& actual, const std::vector<int>& p
     return correct / static_cast<double>(actual.size());
 }
 
+// precision, recall and f1 for the positive label
+void setBinaryScores(BenchmarkResult& result, const ConfusionCounts& c) {
+    	result.precision = safeDiv(c.tp, c.tp + c.fp);
+    	result.recall = safeDiv(c.tp, c.tp + c.fn);
+    	const double denom = (result.precision + result.recall);
+    	result.f1 = (std::isnan(denom) || denom == 0.0)
+                    ? std::numeric_limits<double>::quiet_NaN()
+                    : 2.0 * result.precision * result.recall / denom;
+}
+
+void printResult(const BenchmarkResult& result) {
+    	std::cout << "----------------------------------------" << std::endl;
+    	std::cout << "    Classification Benchmark Results    " << std::endl;
+    	std::cout << "----------------------------------------" << std::endl;
+    	std::cout << "Model: " << result.modelName << std::endl;
+    	std::cout << "Samples: " << result.numSamples << std::endl;
+    	std::cout << "Fit time (ms): " << result.fitMillis << std::endl;
+    	std::cout << "Predict time (ms): " << result.predictMillis << std::endl;
+    	std::cout << "Predict throughput (rows/sec): " << result.predictRowsPerSec << " (" << result.predictThreads << " threads)" << std::endl;
+    	std::cout << "Memory (bytes): " << result.memoryBytes << std::endl;
+    	std::cout << "Accuracy: " << result.accuracy << std::endl;
+    	std::cout << "Precision: " << result.precision << std::endl;
+    	std::cout << "Recall: " << result.recall << std::endl;
+    	std::cout << "F1: " << result.f1 << std::endl;
+    	std::cout << "----------------------------------------" << std::endl;
+}
+
 } // namespace
 
 BenchmarkResult ClassificationBenchmark::execute(const IModel& model, const Dataset& xData, const Dataset& yData, double fitMillis) const {
 	BenchmarkResult result;
     	result.modelName = model.getName();
     	result.taskType = "classification";
-    	result.numSamples = yData.get_data().size();
+    	const Span<const float> actualRaw = yData.values();
+    	result.numSamples = actualRaw.size;
     	result.fitMillis = fitMillis;
 
+    	// the features are read in place (the mapped columns of a binary file too), one prediction per row
+    	std::vector<float> rawPreds(xData.num_rows());
     	const auto startPredict = std::chrono::high_resolution_clock::now();
-    	std::vector<float> rawPreds = model.predict(xData.get_data(), xData.get_columns());
+    	try {
+        	model.predictInto(xData.view(), rawPreds);
+    	} catch (const std::runtime_error& e) { // a model returning the wrong number of predictions
+        	std::cerr << "Benchmark Error: " << e.what() << std::endl;
+        	return result;
+    	}
     	const auto endPredict = std::chrono::high_resolution_clock::now();
     	result.predictMillis = millisBetween(startPredict, endPredict);
+    	result.predictThreads = model.getPredictThreads();
+    	result.predictRowsPerSec = rowsPerSecond(rawPreds.size(), result.predictMillis);
     	result.memoryBytes = static_cast<std::size_t>(currentMemoryUsageBytes());
 
-    	const std::vector<float>& actualRaw = yData.get_data();
-
-    	if (rawPreds.size() != actualRaw.size()) {
+    	if (rawPreds.size() != actualRaw.size) {
         	std::cerr << "Benchmark Error: Prediction size does not match actual size." << std::endl;
         	return result;
     	}
 
-    	std::vector<int> actual(actualRaw.size());
+    	std::vector<int> actual(actualRaw.size);
     	std::vector<int> predicted(rawPreds.size());
 
-    	for (std::size_t i = 0; i < actualRaw.size(); ++i) {
+    	for (std::size_t i = 0; i < actualRaw.size; ++i) {
         	actual[i] = static_cast<int>(std::round(actualRaw[i]));
         	predicted[i] = static_cast<int>(std::round(rawPreds[i]));
     	}
@@ -78,45 +113,83 @@ BenchmarkResult ClassificationBenchmark::execute(const IModel& model, const Data
     	result.accuracy = computeAccuracy(actual, predicted);
 
     	// Basic binary precision/recall/f1 assuming positive label == 1
-    	ConfusionCounts c = computeBinaryConfusion(actual, predicted, 1);
-    	result.precision = safeDiv(c.tp, c.tp + c.fp);
-    	result.recall = safeDiv(c.tp, c.tp + c.fn);
-    	const double denom = (result.precision + result.recall);
-    	result.f1 = (std::isnan(denom) || denom == 0.0)
-                    ? std::numeric_limits<double>::quiet_NaN()
-                    : 2.0 * result.precision * result.recall / denom;
+    	setBinaryScores(result, computeBinaryConfusion(actual, predicted, 1));
 
-    	std::cout << "----------------------------------------" << std::endl;
-    	std::cout << "    Classification Benchmark Results    " << std::endl;
-    	std::cout << "----------------------------------------" << std::endl;
-    	std::cout << "Model: " << result.modelName << std::endl;
-    	std::cout << "Samples: " << result.numSamples << std::endl;
-    	std::cout << "Fit time (ms): " << result.fitMillis << std::endl;
-    	std::cout << "Predict time (ms): " << result.predictMillis << std::endl;
-    	std::cout << "Memory (bytes): " << result.memoryBytes << std::endl;
-    	std::cout << "Accuracy: " << result.accuracy << std::endl;
-    	std::cout << "Precision: " << result.precision << std::endl;
-    	std::cout << "Recall: " << result.recall << std::endl;
-    	std::cout << "F1: " << result.f1 << std::endl;
-    	std::cout << "----------------------------------------" << std::endl;
+    	printResult(result);
+
+    	return result;
+}
+
+BenchmarkResult ClassificationBenchmark::executeStream(const IModel& model, DatasetStream& xStream, DatasetStream& yStream, double fitMillis) const {
+	BenchmarkResult result;
+    	result.modelName = model.getName();
+    	result.taskType = "classification";
+    	result.fitMillis = fitMillis;
+    	result.predictThreads = model.getPredictThreads();
+
+    	// correct predictions and confusion counts accumulate batch by batch
+    	std::size_t count = 0;
+    	double correct = 0.0;
+    	ConfusionCounts c;
+    	std::vector<float> rawPreds;
+    	MatrixView xBatch, yBatch;
+    	while (xStream.next(xBatch)) {
+        	if (!yStream.next(yBatch) || yBatch.rows != xBatch.rows) {
+            		std::cerr << "Benchmark Error: Prediction size does not match actual size." << std::endl;
+            		return result;
+        	}
+
+        	rawPreds.resize(xBatch.rows);
+        	const auto startPredict = std::chrono::high_resolution_clock::now();
+        	model.predictInto(xBatch, rawPreds);
+        	result.predictMillis += millisBetween(startPredict, std::chrono::high_resolution_clock::now());
+
+        	for (std::size_t i = 0; i < xBatch.rows; ++i) {
+            		const int actual = static_cast<int>(std::round(yBatch(i, 0)));
+            		const int predicted = static_cast<int>(std::round(rawPreds[i]));
+            		if (actual == predicted) ++correct;
+            		const bool isPos = actual == 1;
+            		const bool predPos = predicted == 1;
+            		if (isPos && predPos) ++c.tp;
+            		else if (!isPos && predPos) ++c.fp;
+            		else if (isPos && !predPos) ++c.fn;
+            		else ++c.tn;
+        	}
+        	count += xBatch.rows;
+    	}
 
+    	if (yStream.next(yBatch)) {
+        	std::cerr << "Benchmark Error: Prediction size does not match actual size." << std::endl;
+        	return result;
+    	}
+
+    	result.numSamples = count;
+    	result.predictRowsPerSec = rowsPerSecond(count, result.predictMillis);
+    	result.memoryBytes = static_cast<std::size_t>(currentMemoryUsageBytes());
+    	result.accuracy = count == 0 ? std::numeric_limits<double>::quiet_NaN() : correct / static_cast<double>(count);
+    	setBinaryScores(result, c);
+
+    	printResult(result);
     	return result;
 }
 
 double ClassificationBenchmark::evaluate(const IModel& model, const Dataset& features, const Dataset& targets) const {
 
-    	std::vector<float> rawPreds = model.predict(features.get_data(), features.get_columns());
-    	const std::vector<float>& actualRaw = targets.get_data();
+    	std::vector<float> rawPreds(features.num_rows());
+    	model.predictInto(features.view(), rawPreds);
+    	return evaluatePredictions(rawPreds, targets.values());
+}
 
-    	if (rawPreds.size() != actualRaw.size()) {
+double ClassificationBenchmark::evaluatePredictions(Span<const float> rawPreds, Span<const float> actualRaw) const {
+    	if (rawPreds.size != actualRaw.size) {
         	std::cerr << "evaluate: Prediction size mismatch." << std::endl;
         	return std::numeric_limits<double>::infinity(); 
     	}
 
-    	std::vector<int> actual(actualRaw.size());
-    	std::vector<int> predicted(rawPreds.size());
+    	std::vector<int> actual(actualRaw.size);
+    	std::vector<int> predicted(rawPreds.size);
 
-    	for (std::size_t i = 0; i < actualRaw.size(); ++i) {
+    	for (std::size_t i = 0; i < actualRaw.size; ++i) {
         	actual[i] = static_cast<int>(std::round(actualRaw[i]));
         	predicted[i] = static_cast<int>(std::round(rawPreds[i]));
     	}
@@ -0,0 +1,85 @@
+#ifndef CSVPARSING_H
+#define CSVPARSING_H
+
+#include <cctype>
+#include <cstddef>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+
+// cell splitting and float parsing shared by Dataset::read_csv and DatasetStream, both work on raw byte ranges
+// without building strings
+namespace csv {
+	// same cell splitting as getline(ss, cell, ','): a trailing comma does not add an empty cell
+	template <class CellFn>
+	inline void for_each_cell(const char* begin, const char* end, CellFn&& fn) {
+		const char* p = begin;
+		while (p < end) {
+			const char* comma = static_cast<const char*>(std::memchr(p, ',', static_cast<size_t>(end - p)));
+			const char* cellEnd = comma ? comma : end;
+			fn(p, cellEnd);
+			if (!comma) break;
+			p = comma + 1;
+		}
+	}
+
+	// plain decimals ([-]digits[.digits][e[+-]digits]) whose double conversion is exact in a single multiply or divide
+	// (Clinger's fast path); rounding that double to float is also exact unless it lands on a float midpoint
+	inline bool parse_float_fast(const char* p, const char* end, float& value) {
+		static const double powersOf10[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+			1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+		const bool negative = p < end && *p == '-';
+		if (negative) ++p;
+
+		uint64_t mantissa = 0;
+		int digits = 0;
+		int exponent = 0;
+		const char* start = p;
+		for (; p < end && static_cast<unsigned>(*p - '0') < 10; ++p, ++digits) mantissa = mantissa * 10 + static_cast<unsigned>(*p - '0');
+		if (p < end && *p == '.') {
+			++p;
+			for (; p < end && static_cast<unsigned>(*p - '0') < 10; ++p, ++digits, --exponent) mantissa = mantissa * 10 + static_cast<unsigned>(*p - '0');
+		}
+		if (digits == 0 || digits > 19 || (p - start == 1 && *start == '.')) return false;
+
+		if (p < end && (*p == 'e' || *p == 'E')) {
+			++p;
+			const bool negativeExponent = p < end && *p == '-';
+			if (p < end && (*p == '-' || *p == '+')) ++p;
+			int e = 0;
+			const char* exponentStart = p;
+			for (; p < end && static_cast<unsigned>(*p - '0') < 10 && e < 1000; ++p) e = e * 10 + (*p - '0');
+			if (p == exponentStart) return false;
+			exponent += negativeExponent ? -e : e;
+		}
+		if (p < end && !(p + 1 == end && *p == '\r')) return false; // anything else goes through from_chars
+
+		if (mantissa > (uint64_t(1) << 53) || exponent < -22 || exponent > 22) return false;
+		double d = static_cast<double>(mantissa);
+		d = exponent < 0 ? d / powersOf10[-exponent] : d * powersOf10[exponent];
+
+		if (d != 0.0 && (d < 1.17549435e-38 || d > 3.40282347e38)) return false; // subnormal or out of float range
+		uint64_t bits;
+		std::memcpy(&bits, &d, sizeof bits);
+		if ((bits & ((uint64_t(1) << 29) - 1)) == (uint64_t(1) << 28)) return false; // exactly halfway between two floats
+
+		value = static_cast<float>(negative ? -d : d);
+		return true;
+	}
+
+	// parses the leading float of a cell like std::stof (leading whitespace and '+' allowed, trailing text ignored)
+	inline bool parse_float(const char* begin, const char* end, float& value) {
+		if (parse_float_fast(begin, end, value)) return true;
+
+		while (begin < end && std::isspace(static_cast<unsigned char>(*begin))) ++begin;
+		if (begin < end && *begin == '+') {
+			++begin;
+			if (begin < end && *begin == '-') return false;
+		}
+		const auto result = std::from_chars(begin, end, value);
+		return result.ec == std::errc() && result.ptr != begin;
+	}
+}
+
+#endif
@@ -1,6 +1,13 @@
 #include "Dataset.h"
+#include "ThreadPool.h"
+#include "MappedFile.h"
+#include "CsvParsing.h"
 #include <iostream>
 #include <stdexcept>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <utility>
 
 // Use specific using declarations instead of `using namespace std;
 using std::string;
@@ -24,15 +31,19 @@ using std::to_string;
  * For better open source integration, we can re-implement the data loading logic in the future with dataframe libaries and custom definitions.
  * */
 
-Dataset::Dataset(string path, string data_type) : file_path(path), type(data_type) {
+Dataset::Dataset(string path, string data_type, int num_threads) : file_path(path), type(data_type) {
     	// if the data_type is not "train", "test", or "val", throw an exception.
 	if (data_type != "train" && data_type != "test" && data_type != "val") {
 		throw std::invalid_argument("Invalid dataset type, must be train, test or val:" + data_type);
 	}
 
-    	// using the string path, read the csv 
+    	// using the string path, read the csv (or map the binary file)
 	try {
-		read_csv(path);	
+		if (is_binary_path(path)) {
+			read_binary(path);
+		} else {
+			read_csv(path, num_threads);
+		}
 	} catch (const std::runtime_error& e) {
 		cerr << "Error reading file: " << e.what() << endl; 
 	} catch (...) {
@@ -40,7 +51,7 @@ Dataset::Dataset(string path, string data_type) : file_path(path), type(data_typ
 	}
 }
 
-Dataset::Dataset(const std::vector<std::vector<float>>& features, const std::vector<float>& targets) {
+Dataset::Dataset(const std::vector<std::vector<float>>& features, std::vector<float> targets) {
     type = "in-memory";
     data.clear();
     columns.clear();
@@ -65,53 +76,157 @@ Dataset::Dataset(const std::vector<std::vector<float>>& features, const std::vec
         }
     } else if (!targets.empty()) {
         columns.push_back("target");
-        data = targets;
+        data = std::move(targets);
     }
 }
 
-void Dataset::read_csv(string path) {
+Dataset::Dataset(vector<float> values, vector<string> column_names) : type("in-memory"), data(std::move(values)), columns(std::move(column_names)) {
+	if (columns.empty() ? !data.empty() : data.size() % columns.size() != 0) {
+		throw std::invalid_argument("Dataset: value count is not a multiple of the column count");
+	}
+}
+
+namespace {
+	constexpr size_t kReadBlockSize = 1 << 22; // 4 MB per read and thread
+	constexpr size_t kMinChunkBytes = 1 << 20; // smaller blocks are not worth splitting
+
+	// values and conversion errors of one newline-aligned byte range, kept across blocks to reuse the buffers
+	struct CsvChunk {
+		const char* begin = nullptr;
+		const char* end = nullptr;
+		vector<float> values;
+		vector<string> errors;
+	};
+
+	void parse_lines(CsvChunk& chunk) {
+		chunk.values.clear();
+		chunk.errors.clear();
+
+		const char* lineStart = chunk.begin;
+		while (lineStart < chunk.end) {
+			const char* newline = static_cast<const char*>(std::memchr(lineStart, '\n', static_cast<size_t>(chunk.end - lineStart)));
+			const char* lineEnd = newline ? newline : chunk.end;
+			csv::for_each_cell(lineStart, lineEnd, [&](const char* b, const char* e) {
+				float value;
+				if (csv::parse_float(b, e, value)) {
+					chunk.values.push_back(value);
+				} else {
+					chunk.errors.emplace_back(b, e);
+				}
+			});
+			lineStart = lineEnd + 1;
+		}
+	}
+}
+
+void Dataset::read_csv(string path, int num_threads) {
 	// open file, throw exception if it is not
-	ifstream file(path);
+	ifstream file(path, std::ios::binary);
 
     	if (!file.is_open()) {
         	throw std::runtime_error("Error: file not found at " + path);
     	}
 
     	// clear existing data
+    	release_mapping();
     	columns.clear();
     	data.clear();
 
-    	// get the first line, which is the columns.
-    	string col_line;
-    	if (getline(file, col_line)) {
-        	stringstream ss(col_line);
-        	string cell;
+    	file.seekg(0, std::ios::end);
+    	const std::streamoff fileSize = file.tellg();
+    	file.seekg(0, std::ios::beg);
+
+    	// read large blocks and parse whole lines in place, the partial last line is carried into the next block.
+    	// each block is cut into newline-aligned chunks that are parsed in parallel and appended in file order.
+    	const int threads = ThreadPool::resolveThreadCount(num_threads);
+    	vector<char> buffer(std::min<size_t>(kReadBlockSize * static_cast<size_t>(threads), static_cast<size_t>(std::max<std::streamoff>(fileSize, 1))));
+    	vector<CsvChunk> chunks(static_cast<size_t>(threads));
+    	size_t carried = 0;
+    	bool headerRead = false;
+    	bool reserved = false;
+    	bool done = false;
 
-        	while (getline(ss, cell, ',')) {
-            		columns.push_back(cell);
+    	while (!done) {
+        	file.read(buffer.data() + carried, static_cast<std::streamsize>(buffer.size() - carried));
+        	const size_t available = carried + static_cast<size_t>(file.gcount());
+        	done = available < buffer.size(); // a short read means the end of the file
+
+        	const char* begin = buffer.data();
+        	const char* end = begin + available;
+        	const char* stop = end; // one past the last complete line
+        	if (!done) {
+            		while (stop > begin && stop[-1] != '\n') --stop;
+            		if (stop == begin) { // a single line longer than the block
+                		carried = available;
+                		buffer.resize(buffer.size() * 2);
+                		continue;
+            		}
         	}
-    }
 
-    	// get the values and put them into the data 1D vector.
-    	string line;
-    	while (getline(file, line)) {
-        	stringstream ss(line);
-        	string cell;
-
-        while (getline(ss, cell, ',')) {
-        	try {
-                	data.push_back(std::stof(cell));
-            	} catch (const std::invalid_argument& e) {
-                	cerr << "Could not convert string to float: " << cell << endl;
-            	}
-        }
-    }
+        	const char* p = begin;
+        	if (!headerRead) { // the first line is the columns
+            		headerRead = true;
+            		const char* newline = static_cast<const char*>(std::memchr(p, '\n', static_cast<size_t>(stop - p)));
+            		const char* lineEnd = newline ? newline : stop;
+            		csv::for_each_cell(p, lineEnd, [&](const char* b, const char* e) { columns.emplace_back(b, e); });
+            		p = newline ? newline + 1 : stop;
+        	}
+
+        	// chunk boundaries are moved forward to the next line start
+        	const size_t bytes = static_cast<size_t>(stop - p);
+        	const size_t chunkCount = std::max<size_t>(1, std::min(chunks.size(), bytes / kMinChunkBytes));
+        	const char* chunkStart = p;
+        	for (size_t c = 0; c < chunkCount; ++c) {
+            		const char* chunkEnd = c + 1 == chunkCount ? stop : std::max(chunkStart, p + bytes * (c + 1) / chunkCount);
+            		while (chunkEnd < stop && chunkEnd > chunkStart && chunkEnd[-1] != '\n') ++chunkEnd;
+            		chunks[c].begin = chunkStart;
+            		chunks[c].end = chunkEnd;
+            		chunkStart = chunkEnd;
+        	}
+
+        	ThreadPool::shared().parallelFor(0, chunkCount, [&](size_t c) { parse_lines(chunks[c]); });
+
+        	for (size_t c = 0; c < chunkCount; ++c) {
+            		data.insert(data.end(), chunks[c].values.begin(), chunks[c].values.end());
+            		for (const auto& cell : chunks[c].errors) {
+                		cerr << "Could not convert string to float: " << cell << endl;
+            		}
+        	}
+
+        	// reserve once from the bytes per value of the first block
+        	if (!reserved && !data.empty()) {
+            		reserved = true;
+            		const double bytesPerValue = static_cast<double>(stop - begin) / static_cast<double>(data.size());
+            		data.reserve(static_cast<size_t>(static_cast<double>(fileSize) / bytesPerValue * 1.05) + 1);
+        	}
+
+        	carried = static_cast<size_t>(end - stop);
+        	if (carried > 0) std::memmove(buffer.data(), stop, carried);
+    	}
 }
 
 const vector<float>& Dataset::get_data() const { // getter method for the data 
+	if (mapped) {
+		throw std::logic_error("Dataset::get_data: a mapped binary dataset has no row-major data, use view() or call materialize() first.");
+	}
 	return data;
 }
 
+size_t Dataset::num_rows() const {
+	if (mapped) return mapped_rows;
+	return columns.empty() ? 0 : data.size() / columns.size();
+}
+
+Span<const float> Dataset::column(size_t j) const {
+	if (!mapped) {
+		throw std::logic_error("Dataset::column: only a mapped binary dataset stores contiguous columns.");
+	}
+	if (j >= columns.size()) {
+		throw std::out_of_range("Dataset::column: column index out of range.");
+	}
+	return Span<const float>(mapped_columns + j * column_stride, mapped_rows);
+}
+
 string Dataset::get_path() const { // getter for file path 
 	return file_path;
 }
@@ -124,39 +239,218 @@ const vector<string>& Dataset::get_columns() const {
 	return columns;
 }
 
+MatrixView Dataset::view() const {
+	if (mapped) {
+		return MatrixView::columnMajor(mapped_columns, mapped_rows, columns.size(), column_stride);
+	}
+	return MatrixView(data.data(), num_rows(), columns.size());
+}
+
+Span<const float> Dataset::values() const {
+	if (!mapped) {
+		return Span<const float>(data);
+	}
+	if (columns.size() != 1) {
+		throw std::logic_error("Dataset::values: the columns of a mapped dataset are not contiguous, use view() or call materialize() first.");
+	}
+	return column(0);
+}
+
+void Dataset::materialize() {
+	if (!mapped) return;
+
+	const MatrixView mappedView = view();
+	vector<float> values = mappedView.toVector();
+	release_mapping();
+	data = std::move(values);
+}
+
+vector<float> Dataset::take_data() {
+	materialize();
+	vector<float> out = std::move(data);
+	data.clear();
+	return out;
+}
+
 // helper conversion functions 
 std::vector<std::vector<double>> Dataset::get_data_as_double_2d() const {
-    size_t n_cols = columns.size();
-    if (n_cols == 0) return {};
-    size_t n_rows = data.size() / n_cols;
+    const MatrixView X = view();
+    if (X.cols == 0) return {};
     
-    std::vector<std::vector<double>> out(n_rows, std::vector<double>(n_cols));
-    for(size_t i=0; i<n_rows; ++i) {
-        for(size_t j=0; j<n_cols; ++j) {
-            out[i][j] = static_cast<double>(data[i*n_cols + j]);
+    std::vector<std::vector<double>> out(X.rows, std::vector<double>(X.cols));
+    for(size_t i=0; i<X.rows; ++i) {
+        for(size_t j=0; j<X.cols; ++j) {
+            out[i][j] = static_cast<double>(X(i, j));
         }
     }
     return out;
 }
 
 std::vector<double> Dataset::get_data_as_double_1d() const {
-    std::vector<double> out(data.size());
-    for(size_t i=0; i<data.size(); ++i) {
-        out[i] = static_cast<double>(data[i]);
+    const MatrixView X = view();
+    std::vector<double> out;
+    out.reserve(X.rows * X.cols);
+    for(size_t i=0; i<X.rows; ++i) {
+        for(size_t j=0; j<X.cols; ++j) {
+            out.push_back(static_cast<double>(X(i, j)));
+        }
     }
     return out;
 }
 
 // setters for Dataset class, used in classic model factory
 void Dataset::set_data(vector<float> new_data, vector<string> new_cols) { 
-	data = new_data;
-	columns = new_cols;
+	release_mapping();
+	data = std::move(new_data);
+	columns = std::move(new_cols);
 }
 
 void Dataset::set_path(string new_path) { 
-	file_path = new_path;
+	file_path = std::move(new_path);
 }
 
 void Dataset::set_type(string new_type) { 
-	type = new_type;	
+	type = std::move(new_type);
+}
+
+void Dataset::release_mapping() {
+	mapped.reset();
+	mapped_columns = nullptr;
+	mapped_rows = 0;
+	column_stride = 0;
+}
+
+namespace {
+	constexpr char kBinaryMagic[8] = {'M', 'L', 'S', 'B', 'I', 'N', '\0', '\0'};
+	constexpr uint32_t kBinaryVersion = 1;
+	constexpr uint32_t kByteOrderMark = 0x01020304; // reads back differently on a machine of the other endianness
+	constexpr uint32_t kDtypeFloat32 = 1;
+	constexpr uint64_t kColumnAlignment = 64;
+
+	struct BinaryHeader {
+		char magic[8];
+		uint32_t version;
+		uint32_t byte_order;
+		uint32_t dtype;
+		uint32_t alignment;      // byte alignment of every column
+		uint64_t rows;
+		uint64_t cols;
+		uint64_t column_stride;  // values from the start of one column to the next
+		uint64_t data_offset;    // byte offset of the first column, the column names (u32 length + bytes) come before it
+	};
+	static_assert(sizeof(BinaryHeader) == 56, "BinaryHeader layout must not have padding");
+
+	uint64_t align_up(uint64_t value, uint64_t alignment) {
+		return (value + alignment - 1) / alignment * alignment;
+	}
+}
+
+bool Dataset::is_binary_path(const string& path) {
+	const string extension = kBinaryExtension;
+	return path.size() >= extension.size() && path.compare(path.size() - extension.size(), extension.size(), extension) == 0;
+}
+
+void Dataset::read_binary(string path) {
+	auto file = std::make_shared<const MappedFile>(path);
+	const unsigned char* bytes = file->data();
+	const uint64_t size = file->size();
+
+	BinaryHeader header;
+	if (size < sizeof header) {
+		throw std::runtime_error("Error: not a binary dataset: " + path);
+	}
+	std::memcpy(&header, bytes, sizeof header);
+
+	if (std::memcmp(header.magic, kBinaryMagic, sizeof kBinaryMagic) != 0 || header.version != kBinaryVersion) {
+		throw std::runtime_error("Error: not a binary dataset: " + path);
+	}
+	if (header.byte_order != kByteOrderMark || header.dtype != kDtypeFloat32) {
+		throw std::runtime_error("Error: unsupported byte order or dtype in " + path);
+	}
+	if (header.alignment == 0 || header.alignment % sizeof(float) != 0 || header.data_offset % header.alignment != 0
+		|| header.column_stride < header.rows || header.data_offset > size
+		|| (header.cols > 0 && header.column_stride > (size - header.data_offset) / sizeof(float) / header.cols)) {
+		throw std::runtime_error("Error: corrupt binary dataset header in " + path);
+	}
+
+	vector<string> names;
+	uint64_t pos = sizeof header;
+	for (uint64_t j = 0; j < header.cols; ++j) {
+		uint32_t length;
+		if (pos + sizeof length > header.data_offset) {
+			throw std::runtime_error("Error: corrupt column names in " + path);
+		}
+		std::memcpy(&length, bytes + pos, sizeof length);
+		pos += sizeof length;
+		if (length > header.data_offset - pos) {
+			throw std::runtime_error("Error: corrupt column names in " + path);
+		}
+		names.emplace_back(reinterpret_cast<const char*>(bytes + pos), length);
+		pos += length;
+	}
+
+	columns = std::move(names);
+	data.clear();
+	mapped_columns = reinterpret_cast<const float*>(bytes + header.data_offset);
+	mapped_rows = static_cast<size_t>(header.rows);
+	column_stride = static_cast<size_t>(header.column_stride);
+	mapped = std::move(file);
+}
+
+void Dataset::write_binary(const string& path) const {
+	const size_t n_cols = columns.size();
+	if (n_cols == 0) {
+		throw std::invalid_argument("write_binary: dataset has no columns.");
+	}
+	if (!mapped && data.size() % n_cols != 0) {
+		throw std::invalid_argument("write_binary: data size is not a multiple of the number of columns.");
+	}
+	const size_t n_rows = num_rows();
+
+	BinaryHeader header{};
+	std::memcpy(header.magic, kBinaryMagic, sizeof kBinaryMagic);
+	header.version = kBinaryVersion;
+	header.byte_order = kByteOrderMark;
+	header.dtype = kDtypeFloat32;
+	header.alignment = static_cast<uint32_t>(kColumnAlignment);
+	header.rows = n_rows;
+	header.cols = n_cols;
+	header.column_stride = align_up(n_rows * sizeof(float), kColumnAlignment) / sizeof(float);
+
+	uint64_t names_end = sizeof header;
+	for (const auto& name : columns) names_end += sizeof(uint32_t) + name.size();
+	header.data_offset = align_up(names_end, kColumnAlignment);
+
+	std::ofstream out(path, std::ios::binary | std::ios::trunc);
+	if (!out.is_open()) {
+		throw std::runtime_error("Error: cannot write file " + path);
+	}
+
+	out.write(reinterpret_cast<const char*>(&header), sizeof header);
+	for (const auto& name : columns) {
+		const uint32_t length = static_cast<uint32_t>(name.size());
+		out.write(reinterpret_cast<const char*>(&length), sizeof length);
+		out.write(name.data(), static_cast<std::streamsize>(name.size()));
+	}
+	const vector<char> padding(static_cast<size_t>(header.data_offset - names_end), 0);
+	out.write(padding.data(), static_cast<std::streamsize>(padding.size()));
+
+	// one column at a time, zero padded up to the column stride
+	vector<float> values(static_cast<size_t>(header.column_stride), 0.0f);
+	for (size_t j = 0; j < n_cols; ++j) {
+		for (size_t i = 0; i < n_rows; ++i) {
+			values[i] = mapped ? mapped_columns[j * column_stride + i] : data[i * n_cols + j];
+		}
+		out.write(reinterpret_cast<const char*>(values.data()), static_cast<std::streamsize>(values.size() * sizeof(float)));
+	}
+
+	if (!out) {
+		throw std::runtime_error("Error: failed writing " + path);
+	}
+}
+
+void Dataset::convert_csv_to_binary(const string& csv_path, const string& binary_path, int num_threads) {
+	Dataset dataset;
+	dataset.read_csv(csv_path, num_threads);
+	dataset.write_binary(binary_path);
 }
@@ -6,36 +6,81 @@
 #include <stdexcept>
 #include <fstream>
 #include <sstream>
+#include <memory>
+#include "MatrixView.h"
+
+class MappedFile;
 
 class Dataset {
 private:
 
 	std::string file_path;
 	std::string type;
-	std::vector<float> data;
+	std::vector<float> data; // row-major values, empty while a binary file is mapped
 	std::vector<std::string> columns;
 
+	// set when the values are read in place from a binary file: column j starts at mapped_columns + j * column_stride
+	std::shared_ptr<const MappedFile> mapped;
+	const float* mapped_columns = nullptr;
+	size_t mapped_rows = 0;
+	size_t column_stride = 0;
+
+	void release_mapping();
+
 public: 
-	// constructor for loading dataset from a file 
-	Dataset(std::string path, std::string data_type);
+	// binary columnar files are recognised by this extension, everything else is read as csv
+	static constexpr const char* kBinaryExtension = ".mlbin";
+
+	// constructor for loading dataset from a file (csv or binary by extension), num_threads <= 0 parses csv on all hardware threads
+	Dataset(std::string path, std::string data_type, int num_threads = 0);
+
+	// empty dataset, filled by read_csv / read_binary / set_data
+	Dataset() = default;
+
+    // constructor for creating dataset from in-memory vectors, targets are moved in when features is empty
+    Dataset(const std::vector<std::vector<float>>& features, std::vector<float> targets);
 
-    // constructor for creating dataset from in-memory vectors
-    Dataset(const std::vector<std::vector<float>>& features, const std::vector<float>& targets);
+	// row-major values with one name per column, both moved in rather than copied
+	Dataset(std::vector<float> values, std::vector<std::string> column_names);
 	
 	// getters 
-	const std::vector<float>& get_data() const;
+	const std::vector<float>& get_data() const; // row-major values, throws std::logic_error while mapped (see materialize())
+	size_t num_rows() const;
 	std::string get_path() const;
 	std::string get_type() const;
 	const std::vector<std::string>& get_columns() const;
 
-	// helper method for reading csv 
-	void read_csv(std::string path);
+	// borrowed views, valid until the dataset is changed or destroyed: view() is the row-major data, or the mapped
+	// columns in place (MatrixView::columnMajor); values() is every value, so a mapped file needs a single column
+	MatrixView view() const;
+	Span<const float> values() const;
+
+	// copies a mapped file into row-major data and unmaps it, nothing to do otherwise
+	void materialize();
+
+	// moves the row-major values out (materializing a mapped file first) and leaves the dataset without data
+	std::vector<float> take_data();
+
+	// helper method for reading csv, the file is parsed in newline-aligned chunks on num_threads threads
+	void read_csv(std::string path, int num_threads = 0);
+
+	// binary columnar format: header, column names, then one 64-byte aligned float32 column after another.
+	// read_binary maps the file and reads values in place, write_binary writes the current values.
+	void read_binary(std::string path);
+	void write_binary(const std::string& path) const;
+	static bool is_binary_path(const std::string& path);
+	static void convert_csv_to_binary(const std::string& csv_path, const std::string& binary_path, int num_threads = 0);
+
+	// zero-copy access to the values of column j, only while the dataset is mapped (is_mapped())
+	bool is_mapped() const { return mapped != nullptr; }
+	Span<const float> column(size_t j) const;
+	size_t get_column_stride() const { return column_stride; }
 
-    // Helpers to export data as double for specific use cases (like RandomSearch)
+    // Materialized double copies (of the mapped columns too), kept for callers outside the library; view() and values() avoid the copy
     std::vector<std::vector<double>> get_data_as_double_2d() const;
     std::vector<double> get_data_as_double_1d() const;
 
-	// setters 
+	// setters, the arguments are moved in
 	void set_path(std::string new_path); 
 	void set_data(std::vector<float> new_data, std::vector<std::string> new_cols);
 	void set_type(std::string new_type);
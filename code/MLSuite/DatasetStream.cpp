@@ -0,0 +1,205 @@
+#include "DatasetStream.h"
+#include "CsvParsing.h"
+#include "Dataset.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+// reads rows from one file format into a row-major buffer
+class DatasetSource {
+public:
+	virtual ~DatasetSource() = default;
+
+	const std::vector<std::string>& columns() const { return names; }
+
+	// replaces out with up to maxRows rows, returns how many were read (0 at the end of the file)
+	virtual std::size_t read(std::size_t maxRows, std::vector<float>& out) = 0;
+	virtual void rewind() = 0;
+
+protected:
+	std::vector<std::string> names;
+};
+
+namespace {
+	constexpr std::size_t kCsvBlockSize = 1 << 20; // bytes read from the csv at a time
+
+	class CsvSource : public DatasetSource {
+	public:
+		explicit CsvSource(const std::string& filePath) : path(filePath), file(filePath, std::ios::binary), buffer(kCsvBlockSize) {
+			if (!file.is_open()) {
+				throw std::runtime_error("Error: file not found at " + path);
+			}
+			rewind();
+		}
+
+		void rewind() override {
+			file.clear();
+			file.seekg(0, std::ios::beg);
+			pos = filled = 0;
+			atEnd = false;
+			rowIndex = 0;
+
+			names.clear();
+			const char* begin;
+			const char* end;
+			if (nextLine(begin, end)) { // the first line is the columns
+				csv::for_each_cell(begin, end, [&](const char* b, const char* e) { names.emplace_back(b, e); });
+			}
+		}
+
+		std::size_t read(std::size_t maxRows, std::vector<float>& out) override {
+			out.clear();
+			std::size_t rows = 0;
+			const char* begin;
+			const char* end;
+			while (rows < maxRows && nextLine(begin, end)) {
+				const std::size_t before = out.size();
+				csv::for_each_cell(begin, end, [&](const char* b, const char* e) {
+					float value;
+					if (csv::parse_float(b, e, value)) {
+						out.push_back(value);
+					} else {
+						std::cerr << "Could not convert string to float: " << std::string(b, e) << std::endl;
+					}
+				});
+
+				const std::size_t added = out.size() - before;
+				if (added == 0) continue; // blank line
+				if (added != names.size()) {
+					throw std::runtime_error("DatasetStream: row " + std::to_string(rowIndex) + " of " + path + " has " +
+						std::to_string(added) + " values, expected " + std::to_string(names.size()));
+				}
+				++rowIndex;
+				++rows;
+			}
+			return rows;
+		}
+
+	private:
+		std::string path;
+		std::ifstream file;
+		std::vector<char> buffer;
+		std::size_t pos = 0;    // start of the unread bytes in buffer
+		std::size_t filled = 0; // end of the bytes read into buffer
+		bool atEnd = false;
+		std::size_t rowIndex = 0;
+
+		// the next line without its '\n', valid until the next call
+		bool nextLine(const char*& begin, const char*& end) {
+			while (true) {
+				const char* start = buffer.data() + pos;
+				const char* newline = static_cast<const char*>(std::memchr(start, '\n', filled - pos));
+				if (newline) {
+					begin = start;
+					end = newline;
+					pos = static_cast<std::size_t>(newline - buffer.data()) + 1;
+					return true;
+				}
+				if (atEnd) { // the last line may have no '\n'
+					if (pos == filled) return false;
+					begin = start;
+					end = buffer.data() + filled;
+					pos = filled;
+					return true;
+				}
+				refill();
+			}
+		}
+
+		// keeps the unread bytes and reads the next block after them, growing the buffer for lines longer than a block
+		void refill() {
+			std::memmove(buffer.data(), buffer.data() + pos, filled - pos);
+			filled -= pos;
+			pos = 0;
+			if (filled == buffer.size()) buffer.resize(buffer.size() * 2);
+
+			file.read(buffer.data() + filled, static_cast<std::streamsize>(buffer.size() - filled));
+			const std::size_t got = static_cast<std::size_t>(file.gcount());
+			filled += got;
+			if (got == 0) atEnd = true;
+		}
+	};
+
+	// rows are gathered from the mapped columns, only the pages of the current batch are touched
+	class BinarySource : public DatasetSource {
+	public:
+		explicit BinarySource(const std::string& path) {
+			dataset.read_binary(path);
+			names = dataset.get_columns();
+		}
+
+		void rewind() override { cursor = 0; }
+
+		std::size_t read(std::size_t maxRows, std::vector<float>& out) override {
+			const std::size_t rows = std::min(maxRows, dataset.num_rows() - cursor);
+			const std::size_t cols = names.size();
+			out.resize(rows * cols);
+			for (std::size_t j = 0; j < cols; ++j) {
+				const float* values = dataset.column(j).data + cursor;
+				for (std::size_t i = 0; i < rows; ++i) out[i * cols + j] = values[i];
+			}
+			cursor += rows;
+			return rows;
+		}
+
+	private:
+		Dataset dataset;
+		std::size_t cursor = 0;
+	};
+}
+
+DatasetStream::DatasetStream(const std::string& path, std::size_t batchRows, bool prefetchBatches)
+	: batchSize(batchRows), prefetch(prefetchBatches) {
+	if (batchRows == 0) {
+		throw std::invalid_argument("DatasetStream: batchRows must be > 0.");
+	}
+
+	if (Dataset::is_binary_path(path)) {
+		source = std::make_unique<BinarySource>(path);
+	} else {
+		source = std::make_unique<CsvSource>(path);
+	}
+
+	if (prefetch) startPrefetch();
+}
+
+DatasetStream::~DatasetStream() {
+	if (pendingRows.valid()) pendingRows.wait();
+}
+
+const std::vector<std::string>& DatasetStream::columns() const {
+	return source->columns();
+}
+
+void DatasetStream::startPrefetch() {
+	pendingRows = std::async(std::launch::async, [this] { return source->read(batchSize, pending); });
+}
+
+bool DatasetStream::next(MatrixView& batch) {
+	std::size_t rows = 0;
+	if (!prefetch) {
+		rows = source->read(batchSize, current);
+	} else if (pendingRows.valid()) {
+		rows = pendingRows.get(); // rethrows a failed background read
+		std::swap(current, pending);
+		if (rows > 0) startPrefetch();
+	}
+
+	if (rows == 0) {
+		batch = MatrixView();
+		return false;
+	}
+
+	rowsHandedOut += rows;
+	batch = MatrixView(current.data(), rows, source->columns().size());
+	return true;
+}
+
+void DatasetStream::reset() {
+	if (pendingRows.valid()) pendingRows.wait();
+	source->rewind();
+	rowsHandedOut = 0;
+	if (prefetch) startPrefetch();
+}
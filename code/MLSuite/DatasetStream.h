@@ -0,0 +1,46 @@
+#ifndef DATASETSTREAM_H
+#define DATASETSTREAM_H
+
+#include <cstddef>
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+#include "MatrixView.h"
+
+class DatasetSource;
+
+// DatasetStream reads a csv or binary (Dataset::kBinaryExtension) file as row-major batches of at most batchRows rows,
+// so memory stays at two batches however large the file is. With prefetch the next batch is read on a background task
+// while the caller works on the current one. Every csv row must have one value per column; unparseable cells are
+// reported like Dataset::read_csv does and the row then fails with std::runtime_error.
+class DatasetStream {
+public:
+	DatasetStream(const std::string& path, std::size_t batchRows, bool prefetch = true);
+	~DatasetStream();
+
+	DatasetStream(const DatasetStream&) = delete;
+	DatasetStream& operator=(const DatasetStream&) = delete;
+
+	const std::vector<std::string>& columns() const;
+	std::size_t batchRows() const { return batchSize; }
+	std::size_t rowsRead() const { return rowsHandedOut; } // rows returned by next() since the start or the last reset()
+
+	// the next batch, valid until the following next() or reset(); false once every row has been returned
+	bool next(MatrixView& batch);
+	// starts again from the first row
+	void reset();
+
+private:
+	std::unique_ptr<DatasetSource> source;
+	std::size_t batchSize;
+	bool prefetch;
+	std::vector<float> current;
+	std::vector<float> pending; // filled by the background read
+	std::future<std::size_t> pendingRows;
+	std::size_t rowsHandedOut = 0;
+
+	void startPrefetch();
+};
+
+#endif
@@ -1,10 +1,41 @@
 #include "DecisionTree.h"
 #include <algorithm>
 #include <cmath>
+#include <numeric>
+#include <limits>
+#include <mutex>
 #include <stdexcept>
-#include <map>
+#include "ThreadPool.h"
+
+namespace {
+	// below these a node is searched on one thread and its children grown one after the other, the tasks would not pay
+	constexpr std::size_t kMinParallelWork = std::size_t{1} << 15; // node rows * candidate features
+	constexpr int kMinParallelRows = 4096;
+	// histogram cells (node * bin, times the classes for classification) a level-wise search fills at once; a wider
+	// frontier is searched in passes of nodes, so a deep or many-class tree keeps the per-thread buffers this size
+	constexpr int kMaxLevelHistogramCells = 1 << 16;
+
+	// the Scalar kept for a split at t: the largest one not above t, so a float feature x satisfies x <= result
+	// exactly when x <= t and the stored tree partitions its training rows the way the split was scored
+	template <class Scalar>
+	Scalar roundThreshold(double t) {
+		Scalar r = static_cast<Scalar>(t);
+		if (static_cast<double>(r) > t) {
+			r = std::nextafter(r, -std::numeric_limits<Scalar>::infinity());
+		}
+		return r;
+	}
+
+	// soft thresholding of a gradient sum by the L1 penalty
+	double shrink(double g, double alpha) {
+		if (g > alpha) return g - alpha;
+		if (g < -alpha) return g + alpha;
+		return 0.0;
+	}
+}
 
-DecisionTree::DecisionTree(int maxDepth, int minSampleSplit, bool isClassification): 
+template <class Scalar>
+BasicDecisionTree<Scalar>::BasicDecisionTree(int maxDepth, int minSampleSplit, bool isClassification): 
 	maxDepth(maxDepth),
     	minSampleSplit(minSampleSplit),
         isClassification(isClassification),
@@ -12,269 +43,910 @@ DecisionTree::DecisionTree(int maxDepth, int minSampleSplit, bool isClassificati
     	nFeatures(0),
     	isFitted(false) {}
 
-// create a new empty node and return its index
-int DecisionTree::newNode() {
-	int id = static_cast<int>(feature.size());
-    	feature.push_back(-1);
-    	threshold.push_back(0.0);
-    	left.push_back(-1);
-    	right.push_back(-1);
-    	isLeaf.push_back(false);
-    	value.push_back(0.0);
-    	nNodes = static_cast<int>(feature.size());
-    	return id;
+template <class Scalar>
+void BasicDecisionTree<Scalar>::setMaxBins(int bins) {
+	if (bins < 2 || bins > FeatureBins::kMaxBins) {
+		throw std::invalid_argument("setMaxBins: maxBins must be in [2, 256].");
+	}
+	maxBins = bins;
+}
+
+// append an empty node and return its index
+template <class Scalar>
+int BasicDecisionTree<Scalar>::NodeList::add() {
+	const int id = size();
+	feature.push_back(-1);
+	threshold.push_back(0);
+	left.push_back(-1);
+	right.push_back(-1);
+	isLeaf.push_back(false);
+	value.push_back(0);
+	return id;
 }
 
-double DecisionTree::computeMSE(int n, double sum, double sum2) {
+// sub was grown from its own root 0; that root lands on node at and sub's node k >= 1 on base + k - 1
+template <class Scalar>
+void BasicDecisionTree<Scalar>::NodeList::graft(int at, const NodeList& sub) {
+	const int base = size();
+	auto id = [at, base](int k) { return k < 0 ? k : (k == 0 ? at : base + k - 1); };
+	for (int k = 0; k < sub.size(); ++k) {
+		const int dst = (k == 0) ? at : add();
+		feature[dst] = sub.feature[k];
+		threshold[dst] = sub.threshold[k];
+		left[dst] = id(sub.left[k]);
+		right[dst] = id(sub.right[k]);
+		isLeaf[dst] = sub.isLeaf[k];
+		value[dst] = sub.value[k];
+	}
+}
+
+// free list of split buffers, sized for the fit on creation; a task borrows one through a Lease
+template <class Scalar>
+class BasicDecisionTree<Scalar>::ScratchPool {
+public:
+	ScratchPool(int rows, int bins, int classes, bool classification)
+		: rows(rows), bins(bins), classes(classes), classification(classification) {}
+
+	class Lease {
+	public:
+		explicit Lease(ScratchPool& pool) : pool(pool), buffers(pool.acquire()) {}
+		~Lease() { pool.release(std::move(buffers)); }
+		Lease(const Lease&) = delete;
+		Lease& operator=(const Lease&) = delete;
+		SplitScratch& operator*() const { return *buffers; }
+
+	private:
+		ScratchPool& pool;
+		std::unique_ptr<SplitScratch> buffers;
+	};
+
+private:
+	std::mutex mutex;
+	std::vector<std::unique_ptr<SplitScratch>> free;
+	int rows, bins, classes;
+	bool classification;
+
+	std::unique_ptr<SplitScratch> acquire() {
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			if (!free.empty()) {
+				auto buffers = std::move(free.back());
+				free.pop_back();
+				return buffers;
+			}
+		}
+		auto buffers = std::make_unique<SplitScratch>();
+		buffers->sorted.resize(rows);
+		buffers->histCount.resize(bins);
+		if (classification) {
+			buffers->histClass.resize(static_cast<std::size_t>(bins) * classes);
+		} else {
+			buffers->histSum.resize(bins);
+			buffers->histSum2.resize(bins);
+		}
+		buffers->countsL.resize(classes);
+		buffers->countsR.resize(classes);
+		return buffers;
+	}
+
+	void release(std::unique_ptr<SplitScratch> buffers) {
+		std::lock_guard<std::mutex> lock(mutex);
+		free.push_back(std::move(buffers));
+	}
+};
+
+// number of training samples in a node, rows count once per bootstrap draw
+template <class Scalar>
+int BasicDecisionTree<Scalar>::nodeWeight(int begin, int end) const {
+	const int* rows = rowsOf(begin);
+	int n = 0;
+	for (int k = 0; k < end - begin; ++k) n += weight[rows[k]];
+	return n;
+}
+
+template <class Scalar>
+double BasicDecisionTree<Scalar>::computeMSE(int n, double sum, double sum2) const {
     	if (n <= 0) return 0.0;
     	double mean = sum / n;
     	// population MSE of residuals (variance * n / n = variance)
     	return (sum2 / n) - (mean * mean);
 }
 
-double DecisionTree::computeGini(const std::vector<int>& indices, const std::vector<double>& Y) {
-    if (indices.empty()) return 0.0;
-    std::map<double, int> counts;
-    for (int idx : indices) {
-        counts[Y[idx]]++;
-    }
-    double n = static_cast<double>(indices.size());
-    double sumSq = 0.0;
-    for (auto const& [label, count] : counts) {
-        double p = count / n;
-        sumSq += p * p;
-    }
-    return 1.0 - sumSq;
+// weighted Gini decrease from the sums of squared class counts of each side, Gini(n, sq) = 1 - sq / n^2
+template <class Scalar>
+double BasicDecisionTree<Scalar>::giniDecrease(int nP, double giniP, int nL, double sqL, int nR, double sqR) const {
+	if (nL == 0 || nR == 0) return 0.0;
+	// nL * giniL + nR * giniR = nP - sqL / nL - sqR / nR
+	return giniP - (static_cast<double>(nP) - sqL / nL - sqR / nR) / static_cast<double>(nP);
 }
 
-double DecisionTree::impurityDecrease(int nP, double sumP, double sumP2,
+template <class Scalar>
+double BasicDecisionTree<Scalar>::leafWeight(double g, double h) const {
+	const double denom = h + gradientParams.lambda;
+	const double weight = denom > 0.0 ? -shrink(g, gradientParams.alpha) / denom : 0.0;
+	const double cap = gradientParams.maxDeltaStep;
+	return cap > 0.0 ? std::max(-cap, std::min(cap, weight)) : weight;
+}
+
+// structure score gain of a split; 0 (never taken) when a child is too light or the gain does not beat gamma
+template <class Scalar>
+double BasicDecisionTree<Scalar>::newtonGain(double gP, double hP, double gL, double hL, double gR, double hR) const {
+	if (hL < gradientParams.minChildWeight || hR < gradientParams.minChildWeight) return 0.0;
+	auto score = [this](double g, double h) {
+		const double denom = h + gradientParams.lambda;
+		const double t = shrink(g, gradientParams.alpha);
+		return denom > 0.0 ? t * t / denom : 0.0;
+	};
+	return std::max(0.0, 0.5 * (score(gL, hL) + score(gR, hR) - score(gP, hP)) - gradientParams.gamma);
+}
+
+// weighted MSE decrease from running sums, no row indices needed; with gradients the sums are (G, H) and the
+// Newton gain is returned instead
+template <class Scalar>
+double BasicDecisionTree<Scalar>::impurityDecrease(int nP, double sumP, double sumP2,
 				      int nL, double sumL, double sumL2,
-                                      int nR, double sumR, double sumR2,
-                                      const std::vector<int>& indicesP,
-                                      const std::vector<int>& indicesL,
-                                      const std::vector<int>& indicesR,
-                                      const std::vector<double>& Y) {
+                                      int nR, double sumR, double sumR2) const {
 	if (nL == 0 || nR == 0) return 0.0;
-    
-    if (isClassification) {
-        double parentImp = computeGini(indicesP, Y);
-        double leftImp   = computeGini(indicesL, Y);
-        double rightImp  = computeGini(indicesR, Y);
-        return parentImp - ( (static_cast<double>(nL) * leftImp + static_cast<double>(nR) * rightImp) / static_cast<double>(nP) );
-    } else {
+	if (hessian) return newtonGain(sumP, sumP2, sumL, sumL2, sumR, sumR2);
+
     	double parentImp = computeMSE(nP, sumP, sumP2);
     	double leftImp   = computeMSE(nL, sumL, sumL2);
     	double rightImp  = computeMSE(nR, sumR, sumR2);
     	return parentImp - ( (static_cast<double>(nL) * leftImp + static_cast<double>(nR) * rightImp) / static_cast<double>(nP) ); // weighted decrease is needed
-    }
 }
 
-// CART partition 
-std::tuple<std::vector<int>, std::vector<int>>
-DecisionTree::partitionByThreshold(const std::vector<std::vector<double>>& X,
-                                   int feat, double thr,
-                                   const std::vector<int>& indices) {
-	std::vector<int> L, R;
-    	L.reserve(indices.size());
-    	R.reserve(indices.size());
-
-    	for (int idx : indices) {
-        	if (X[idx][feat] <= thr) L.push_back(idx);
-        	else R.push_back(idx);
-    	}
+// row ids of the node starting at begin; in Presorted mode every feature segment holds the same rows
+template <class Scalar>
+const int* BasicDecisionTree<Scalar>::rowsOf(int begin) const {
+	return (splitMode == SplitMode::Presorted) ? presorted.data() + begin : nodeRows.data() + begin;
+}
+
+template <class Scalar>
+bool BasicDecisionTree<Scalar>::splitInParallel(std::size_t work) const {
+	return work >= kMinParallelWork && ThreadPool::resolveThreadCount(numThreads) > 1;
+}
+
+// the first levels hand their two subtrees to separate tasks until every thread has one; a feature sampler
+// draws from one random stream in node order, so its trees are grown serially
+template <class Scalar>
+bool BasicDecisionTree<Scalar>::growSiblingsInParallel(int depth, int rows) const {
+	if (featureSampler || rows < kMinParallelRows || depth >= 30) return false;
+	return (1 << depth) < ThreadPool::resolveThreadCount(numThreads);
+}
+
+// CART partition, done in place on the node's [begin, end) range and stable so presorted segments stay sorted.
+// Only the range's own rows and scratch positions are touched, so sibling subtrees can partition concurrently.
+// Returns the first position of the right child.
+template <class Scalar>
+int BasicDecisionTree<Scalar>::partitionNode(const FeatureMatrix& X,
+                                int feat, Scalar thr,
+                                int begin, int end) {
+	const int* rows = rowsOf(begin);
+	for (int k = 0; k < end - begin; ++k) {
+		const int r = rows[k];
+		goesLeft[r] = X(r, feat) <= thr;
+	}
 
-    return {L, R};
+	auto stablePartition = [&](int* seg) {
+		int nL = 0, nR = 0;
+		for (int k = 0; k < end - begin; ++k) {
+			const int r = seg[k];
+			if (goesLeft[r]) seg[nL++] = r;
+			else partitionScratch[begin + nR++] = r;
+		}
+		std::copy(partitionScratch.begin() + begin, partitionScratch.begin() + begin + nR, seg + nL);
+		return nL;
+	};
+
+	int nL = 0;
+	if (splitMode == SplitMode::Presorted) {
+		for (int f = 0; f < nFeatures; ++f) {
+			nL = stablePartition(presorted.data() + static_cast<std::size_t>(f) * nSamples + begin);
+		}
+	} else {
+		nL = stablePartition(nodeRows.data() + begin);
+	}
+	return begin + nL;
 }
 
 // leaf node definition
-void DecisionTree::makeLeaf(int nodeIndex,
-                            const std::vector<int>& indices,
-                            const std::vector<double>& Y) {
-    if (indices.empty()) {
-        isLeaf[nodeIndex] = true;
-        value[nodeIndex] = 0.0;
+template <class Scalar>
+void BasicDecisionTree<Scalar>::makeLeaf(NodeList& out, int nodeIndex,
+                            int begin, int end,
+                            Span<const Scalar> Y) {
+    const int* rows = rowsOf(begin);
+    const int n = end - begin;
+    out.isLeaf[nodeIndex] = true;
+    out.feature[nodeIndex] = -1;
+    out.threshold[nodeIndex] = 0;
+    out.left[nodeIndex] = -1;
+    out.right[nodeIndex] = -1;
+    if (n == 0) {
+        out.value[nodeIndex] = 0;
         return;
     }
 
     if (isClassification) {
-        // Mode (majority vote)
-        std::map<double, int> counts;
-        for (int i : indices) counts[Y[i]]++;
-        double bestLabel = Y[indices[0]];
-        int maxCount = -1;
-        for (auto const& [label, count] : counts) {
-            if (count > maxCount) {
-                maxCount = count;
-                bestLabel = label;
-            }
+        // Mode (majority vote) over the dense class ids, ties go to the smallest label
+        typename ScratchPool::Lease lease(*scratch);
+        std::vector<int>& counts = (*lease).countsL;
+        std::fill(counts.begin(), counts.end(), 0);
+        for (int k = 0; k < n; ++k) counts[classIndex[rows[k]]] += weight[rows[k]];
+        int bestClass = 0;
+        for (int c = 1; c < nClasses; ++c) {
+            if (counts[c] > counts[bestClass]) bestClass = c;
         }
-        value[nodeIndex] = bestLabel;
+        out.value[nodeIndex] = classLabels[bestClass];
     } else {
 	    // Mean of Y at this node
 	    double s = 0.0;
-	    for (int i : indices) s += Y[i];
-	    double mean = s / indices.size();
-        value[nodeIndex] = mean;
+	    int w = 0;
+	    double h = 0.0;
+	    for (int k = 0; k < n; ++k) {
+	        s += weight[rows[k]] * static_cast<double>(Y[rows[k]]);
+	        w += weight[rows[k]];
+	        if (hessian) h += weight[rows[k]] * static_cast<double>(hessian[rows[k]]);
+	    }
+	    double mean = s / w;
+        out.value[nodeIndex] = static_cast<Scalar>(hessian ? leafWeight(s, h) : mean);
     }
 
-    	isLeaf[nodeIndex] = true;
-    	feature[nodeIndex] = -1;
-    	threshold[nodeIndex] = 0.0;
-    	left[nodeIndex] = -1;
-    	right[nodeIndex] = -1;
+    // every row belongs to exactly one leaf, so concurrent subtrees write disjoint entries
+    if (leafValuesOut.data) {
+        for (int k = 0; k < n; ++k) leafValuesOut[rows[k]] = out.value[nodeIndex];
+    }
 }
 
-// return a decision tree with the best split params 
-// Return: (bestFeat, bestThr, bestGain, bestLeftIdx, bestRightIdx)
-std::tuple<int, double, double, std::vector<int>, std::vector<int>>
-DecisionTree::bestSplit(const std::vector<std::vector<double>>& X,
-                        const std::vector<double>& Y,
-                        const std::vector<int>& indices) {
+// weighted row count, target sums and class counts of the node in [begin, end)
+template <class Scalar>
+typename BasicDecisionTree<Scalar>::NodeStats
+BasicDecisionTree<Scalar>::nodeStats(Span<const Scalar> Y, int begin, int end) const {
+    	const int* rows = rowsOf(begin);
+    	NodeStats node;
+    	node.m = end - begin;
+    	node.countsP.assign(isClassification ? nClasses : 0, 0);
 
-    	int n = static_cast<int>(indices.size());
-    	if (n < minSampleSplit || n == 0) {
-        	return {-1, 0.0, 0.0, {}, {}};
+    	// parent values
+    	for (int k = 0; k < node.m; ++k) {
+    		const int i = rows[k];
+    		const int w = weight[i];
+    		node.n += w;
+    		if (isClassification) {
+    			node.countsP[classIndex[i]] += w;
+    		} else {
+        	    const double y = Y[i];
+        	    node.sumP += w * y;
+        	    node.sumP2 += hessian ? w * static_cast<double>(hessian[i]) : w * y * y;
+    		}
     	}
+    	for (int c : node.countsP) node.sqP += static_cast<double>(c) * c;
+    	if (node.n > 0) node.giniP = 1.0 - node.sqP / (static_cast<double>(node.n) * node.n);
+    	return node;
+}
 
-    	// parent values
-    	double sumP = 0.0, sumP2 = 0.0;
-        if (!isClassification) {
-    	    for (int i : indices) {
-        	    double y = Y[i];
-        	    sumP += y;
-        	    sumP2 += y * y;
-    	    }
-        }
+// return the best split params, scored only from running sufficient statistics
+// Return: (bestFeat, bestThr, bestGain); the partition is materialized once by the caller
+template <class Scalar>
+std::tuple<int, Scalar, double>
+BasicDecisionTree<Scalar>::bestSplit(const FeatureMatrix& X,
+                        Span<const Scalar> Y,
+                        int begin, int end) {
+
+    	const NodeStats node = nodeStats(Y, begin, end);
+    	if (node.n < minSampleSplit || node.n == 0) {
+        	return {-1, 0.0, 0.0};
+    	}
 
-    	double bestGain = 0.0;
-    	int bestFeat = -1;
-    	double bestThr = 0.0;
-    	std::vector<int> bestL, bestR;
-
-    	for (int f = 0; f < nFeatures; ++f) {
-        	// get (x_f, y, idx) for this subset and sort by feature value
-        	std::vector<std::tuple<double,double,int>> rows;
-        	rows.reserve(n);
-        	for (int i : indices) {
-            		rows.emplace_back(X[i][f], Y[i], i);
-        	}
-        	std::sort(rows.begin(), rows.end(),
-                  [](const auto& a, const auto& b){
-                      return std::get<0>(a) < std::get<0>(b);
-                  });
-
-        	// prefix values for left, suffix via totals for right
-        	double sumL = 0.0, sumL2 = 0.0;
-        	int nL = 0;
-
-        	// sweep all possible split points between distinct adjacent feature values
-        	for (int s = 0; s < n - 1; ++s) {
-            		double x_s, y_s; int idx_s;
-            		std::tie(x_s, y_s, idx_s) = rows[s];
-            		sumL += y_s;
-            		sumL2 += y_s * y_s;
-            		++nL;
-
-            		double x_next = std::get<0>(rows[s+1]);
-            		if (x_s == x_next) {
-                	// there will be no threshold between equal values—skip
-                	continue;
-            	}
-
-            	int nR = n - nL;
-            	if (nL < 1 || nR < 1) continue;
-
-            	double sumR  = sumP - sumL;
-            	double sumR2 = sumP2 - sumL2;
-
-            	// the threshold is midway between x_s and x_next
-            	double thr = 0.5 * (x_s + x_next);
-
-                // materialize index partitions for impurityDecrease if needed
-                std::vector<int> L; L.reserve(nL); // NOTE: there is a better way of doing this, but simplicity is best for now
-                std::vector<int> R; R.reserve(nR);
-                for (int k = 0; k <= s; ++k) L.push_back(std::get<2>(rows[k]));
-                for (int k = s+1; k < n; ++k) R.push_back(std::get<2>(rows[k]));
-
-            	double gain = impurityDecrease(n, sumP, sumP2, nL, sumL, sumL2, nR, sumR, sumR2, indices, L, R, Y);
-
-            	if (gain > bestGain) {
-                	bestGain = gain;
-                	bestFeat = f;
-                	bestThr = thr;
-                    bestL.swap(L);
-                    bestR.swap(R);
-			    }
-        	}
-	}
+    	auto scan = [&](int f, SplitScratch& buffers) {
+    		return (splitMode == SplitMode::Histogram) ? scanHistogram(Y, f, begin, node, buffers)
+    		                                           : scanExact(X, Y, f, begin, node, buffers);
+    	};
+
+    	// features keep their candidate order and a later one must gain strictly more, so the winner does not
+    	// depend on how the features were spread over threads
+    	const int nCandidates = static_cast<int>(candidateFeatures.size());
+    	SplitCandidate best;
+    	if (!splitInParallel(static_cast<std::size_t>(node.m) * nCandidates)) {
+    		typename ScratchPool::Lease lease(*scratch);
+    		for (int f : candidateFeatures) {
+    			const SplitCandidate c = scan(f, *lease);
+    			if (c.gain > best.gain) best = c;
+    		}
+    	} else {
+    		std::vector<SplitCandidate> results(nCandidates);
+    		const int tasks = std::min(ThreadPool::resolveThreadCount(numThreads), nCandidates);
+    		ThreadPool::shared().parallelFor(0, tasks, [&](std::size_t t) {
+    			typename ScratchPool::Lease lease(*scratch);
+    			for (int k = static_cast<int>(t); k < nCandidates; k += tasks) {
+    				results[k] = scan(candidateFeatures[k], *lease);
+    			}
+    		});
+    		for (const SplitCandidate& c : results) {
+    			if (c.gain > best.gain) best = c;
+    		}
+    	}
 
-	if (bestFeat == -1) {
-        return {-1, 0.0, 0.0, {}, {}};
+	if (best.feature == -1) {
+        return {-1, 0.0, 0.0};
     }
 
-    return {bestFeat, bestThr, bestGain, bestL, bestR};
+    return {best.feature, roundThreshold<Scalar>(best.threshold), best.gain};
+}
+
+// sorted sweep of one feature (Exact and Presorted), tries the midpoint between every two distinct values
+template <class Scalar>
+typename BasicDecisionTree<Scalar>::SplitCandidate
+BasicDecisionTree<Scalar>::scanExact(const FeatureMatrix& X, Span<const Scalar> Y, int f, int begin,
+                                     const NodeStats& node, SplitScratch& buffers) const {
+	const int m = node.m;
+	const int n = node.n;
+	auto& sorted = buffers.sorted;
+	if (splitMode == SplitMode::Presorted) {
+		// the node's segment of this feature is already in (x_f, row) order, just gather the values
+		const int* seg = presorted.data() + static_cast<std::size_t>(f) * nSamples + begin;
+		for (int k = 0; k < m; ++k) {
+			sorted[k] = {X(seg[k], f), seg[k]};
+		}
+	} else {
+		// get (x_f, idx) for this subset and sort by feature value (row id breaks ties, same order as Presorted)
+		const int* rows = rowsOf(begin);
+		for (int k = 0; k < m; ++k) {
+			sorted[k] = {X(rows[k], f), rows[k]};
+		}
+		std::sort(sorted.begin(), sorted.begin() + m);
+	}
+
+	SplitCandidate best;
+	// prefix values for left, suffix via totals for right
+	double sumL = 0.0, sumL2 = 0.0;
+	int nL = 0;
+	// left/right class counts and their sums of squares, each moved row is an O(1) update
+	auto& countsL = buffers.countsL;
+	auto& countsR = buffers.countsR;
+	std::fill(countsL.begin(), countsL.end(), 0);
+	std::copy(node.countsP.begin(), node.countsP.end(), countsR.begin());
+	double sqL = 0.0, sqR = node.sqP;
+
+	// sweep all possible split points between distinct adjacent feature values
+	for (int s = 0; s < m - 1; ++s) {
+		const float x_s = sorted[s].first;
+		const int idx_s = sorted[s].second;
+		const int w = weight[idx_s];
+		if (isClassification) {
+			const int c = classIndex[idx_s];
+			sqL += w * (2.0 * countsL[c] + w);
+			sqR -= w * (2.0 * countsR[c] - w);
+			countsL[c] += w;
+			countsR[c] -= w;
+		} else {
+			const double y = Y[idx_s];
+			sumL += w * y;
+			sumL2 += hessian ? w * static_cast<double>(hessian[idx_s]) : w * y * y;
+		}
+		nL += w;
+
+		const float x_next = sorted[s + 1].first;
+		if (x_s == x_next) {
+			// there will be no threshold between equal values—skip
+			continue;
+		}
+
+		const int nR = n - nL;
+		if (nL < 1 || nR < 1) continue;
+
+		double gain;
+		if (isClassification) {
+			gain = giniDecrease(n, node.giniP, nL, sqL, nR, sqR);
+		} else {
+			gain = impurityDecrease(n, node.sumP, node.sumP2, nL, sumL, sumL2, nR, node.sumP - sumL, node.sumP2 - sumL2);
+		}
+
+		if (gain > best.gain) {
+			best.gain = gain;
+			best.feature = f;
+			best.threshold = 0.5 * (static_cast<double>(x_s) + x_next); // the threshold is midway between x_s and x_next
+		}
+	}
+	return best;
 }
 
-void DecisionTree::buildTree(const std::vector<std::vector<double>>& X,
-                             const std::vector<double>& Y,
-                             const std::vector<int>& indices,
+// histogram split search over pre-quantized features: one pass over the node's rows to fill the bin
+// statistics, then a sweep over at most maxBins - 1 boundaries instead of a sort of the node
+template <class Scalar>
+typename BasicDecisionTree<Scalar>::SplitCandidate
+BasicDecisionTree<Scalar>::scanHistogram(Span<const Scalar> Y, int f, int begin,
+                                         const NodeStats& node, SplitScratch& buffers) const {
+	const int nb = bins->getNBins(f);
+	if (nb < 2) return SplitCandidate(); // constant feature
+	const std::uint8_t* col = bins->column(f);
+	const int* rows = rowsOf(begin);
+	const int m = node.m;
+
+	auto& histCount = buffers.histCount;
+	auto& histClass = buffers.histClass;
+	auto& histSum = buffers.histSum;
+	auto& histSum2 = buffers.histSum2;
+	std::fill(histCount.begin(), histCount.begin() + nb, 0);
+	if (isClassification) {
+		std::fill(histClass.begin(), histClass.begin() + static_cast<std::size_t>(nb) * nClasses, 0);
+		for (int k = 0; k < m; ++k) {
+			const int i = rows[k];
+			const int b = col[i];
+			histCount[b] += weight[i];
+			histClass[static_cast<std::size_t>(b) * nClasses + classIndex[i]] += weight[i];
+		}
+	} else {
+		std::fill(histSum.begin(), histSum.begin() + nb, 0.0);
+		std::fill(histSum2.begin(), histSum2.begin() + nb, 0.0);
+		for (int k = 0; k < m; ++k) {
+			const int i = rows[k];
+			const int b = col[i];
+			const double y = Y[i];
+			histCount[b] += weight[i];
+			histSum[b] += weight[i] * y;
+			histSum2[b] += hessian ? weight[i] * static_cast<double>(hessian[i]) : weight[i] * y * y;
+		}
+	}
+	return sweepHistogram(f, node, histCount.data(), histSum.data(), histSum2.data(), histClass.data(), buffers);
+}
+
+template <class Scalar>
+typename BasicDecisionTree<Scalar>::SplitCandidate
+BasicDecisionTree<Scalar>::sweepHistogram(int f, const NodeStats& node, const int* histCount, const double* histSum,
+                                          const double* histSum2, const int* histClass, SplitScratch& buffers) const {
+	SplitCandidate best;
+	const int nb = bins->getNBins(f);
+	const int n = node.n;
+
+	// sweep bin boundaries, left = bins [0, b]
+	int nL = 0;
+	double sumL = 0.0, sumL2 = 0.0;
+	auto& countsL = buffers.countsL;
+	auto& countsR = buffers.countsR;
+	std::fill(countsL.begin(), countsL.end(), 0);
+	std::copy(node.countsP.begin(), node.countsP.end(), countsR.begin());
+	double sqL = 0.0, sqR = node.sqP;
+	int bestBin = -1;
+	for (int b = 0; b < nb - 1; ++b) {
+		nL += histCount[b];
+		if (isClassification) {
+			const int* binCounts = &histClass[static_cast<std::size_t>(b) * nClasses];
+			for (int c = 0; c < nClasses; ++c) {
+				const double cnt = binCounts[c];
+				sqL += cnt * (2.0 * countsL[c] + cnt);
+				sqR -= cnt * (2.0 * countsR[c] - cnt);
+				countsL[c] += binCounts[c];
+				countsR[c] -= binCounts[c];
+			}
+		} else {
+			sumL += histSum[b];
+			sumL2 += histSum2[b];
+		}
+
+		const int nR = n - nL;
+		if (nL == 0 || histCount[b + 1] == 0) continue; // empty side or no rows at this boundary
+		if (nR == 0) break;
+
+		double gain;
+		if (isClassification) {
+			gain = giniDecrease(n, node.giniP, nL, sqL, nR, sqR);
+		} else {
+			gain = impurityDecrease(n, node.sumP, node.sumP2, nL, sumL, sumL2, nR, node.sumP - sumL, node.sumP2 - sumL2);
+		}
+
+		if (gain > best.gain) {
+			best.gain = gain;
+			bestBin = b;
+		}
+	}
+
+	if (bestBin >= 0) {
+		// x <= cut(f, b) holds exactly for the rows in bins [0, b], so the caller's partition matches the histogram
+		best.feature = f;
+		best.threshold = bins->cut(f, bestBin);
+	}
+	return best;
+}
+
+// grows the subtree of the rows in [begin, end) of the shared row buffer into out, children get the two halves of that range
+template <class Scalar>
+void BasicDecisionTree<Scalar>::buildTree(const FeatureMatrix& X,
+                             Span<const Scalar> Y,
+                             int begin, int end,
                              int depth,
+                             NodeList& out,
                              int nodeIndex) {
 	// stopping criteria
-    	if (depth >= maxDepth || static_cast<int>(indices.size()) < minSampleSplit) {
-        	makeLeaf(nodeIndex, indices, Y);
+    	if (depth >= maxDepth || nodeWeight(begin, end) < minSampleSplit) {
+        	makeLeaf(out, nodeIndex, begin, end, Y);
         	return;
     	}
 
-    	auto [bf, thr, gain, Lidx, Ridx] = bestSplit(X, Y, indices);
+    	if (featureSampler) {
+    		featureSampler(nFeatures, candidateFeatures);
+    	}
+    	auto [bf, thr, gain] = bestSplit(X, Y, begin, end);
 
     	if (bf == -1 || gain <= 0.0) {
-        	makeLeaf(nodeIndex, indices, Y);
+        	makeLeaf(out, nodeIndex, begin, end, Y);
         	return;
     	}
 
-    	// children
-    	int lch = newNode();
-    	int rch = newNode();
+    	// partition the node's range once, for the winning split only
+    	const int mid = partitionNode(X, bf, thr, begin, end);
 
-    	feature[nodeIndex] = bf;
-    	threshold[nodeIndex] = thr;
-    	left[nodeIndex] = lch;
-    	right[nodeIndex] = rch;
-    	isLeaf[nodeIndex] = false;
-    	value[nodeIndex] = 0.0; // not needed for internal nodes
+    	// children
+    	int lch = out.add();
+    	int rch = out.add();
+
+    	out.feature[nodeIndex] = bf;
+    	out.threshold[nodeIndex] = thr;
+    	out.left[nodeIndex] = lch;
+    	out.right[nodeIndex] = rch;
+    	out.isLeaf[nodeIndex] = false;
+    	out.value[nodeIndex] = 0; // not needed for internal nodes
+
+    	if (growSiblingsInParallel(depth, end - begin)) {
+    		// each side grows into its own list over its own row range, grafted back in depth-first order
+    		NodeList sides[2];
+    		sides[0].add();
+    		sides[1].add();
+    		ThreadPool::shared().parallelFor(0, 2, [&](std::size_t side) {
+    			if (side == 0) buildTree(X, Y, begin, mid, depth + 1, sides[0], 0);
+    			else buildTree(X, Y, mid, end, depth + 1, sides[1], 0);
+    		});
+    		out.graft(lch, sides[0]);
+    		out.graft(rch, sides[1]);
+    		return;
+    	}
 
     	// recursive call  
-    	buildTree(X, Y, Lidx, depth + 1, lch);
-    	buildTree(X, Y, Ridx, depth + 1, rch);
+    	buildTree(X, Y, begin, mid, depth + 1, out, lch);
+    	buildTree(X, Y, mid, end, depth + 1, out, rch);
 }
 
-void DecisionTree::fit(const std::vector<std::vector<double>>& X,
-                       const std::vector<double>& Y) {
+// grows the tree one depth at a time. Nodes stop and split under the same rules as buildTree and search their
+// features in the same order, and Histogram rows are visited in ascending row id within every node (the order of
+// nodeRows), so the bin sums and the chosen splits match the recursive build exactly.
+template <class Scalar>
+void BasicDecisionTree<Scalar>::buildLevelWise(const FeatureMatrix& X, Span<const Scalar> Y, int nSampled) {
+	struct Frontier { int node, begin, end; };
+	std::vector<Frontier> level{{nodes.add(), 0, nSampled}}, open, next;
+	std::vector<NodeStats> stats;
+	std::vector<int> candidates;      // searched features of every open node back to back, nFeatures each
+	std::vector<int> nCandidates;
+	std::vector<char> searched;       // open node * nFeatures
+	std::vector<SplitCandidate> results; // open node * nFeatures
+	std::vector<int> rowSlot;         // Histogram: open node of every row, -1 for the rest
+	if (splitMode == SplitMode::Histogram) rowSlot.assign(nSamples, -1);
+
+	for (int depth = 0; !level.empty(); ++depth) {
+		open.clear();
+		stats.clear();
+		candidates.clear();
+		nCandidates.clear();
+		std::size_t openRows = 0;
+		for (const Frontier& fr : level) {
+			if (depth >= maxDepth || nodeWeight(fr.begin, fr.end) < minSampleSplit) {
+				makeLeaf(nodes, fr.node, fr.begin, fr.end, Y);
+				continue;
+			}
+			if (featureSampler) {
+				featureSampler(nFeatures, candidateFeatures);
+			}
+			open.push_back(fr);
+			stats.push_back(nodeStats(Y, fr.begin, fr.end));
+			candidates.insert(candidates.end(), candidateFeatures.begin(), candidateFeatures.end());
+			candidates.resize(open.size() * nFeatures);
+			nCandidates.push_back(static_cast<int>(candidateFeatures.size()));
+			openRows += fr.end - fr.begin;
+		}
+		const int nOpen = static_cast<int>(open.size());
+		if (nOpen == 0) break;
+
+		searched.assign(static_cast<std::size_t>(nOpen) * nFeatures, 0);
+		for (int s = 0; s < nOpen; ++s) {
+			for (int k = 0; k < nCandidates[s]; ++k) searched[static_cast<std::size_t>(s) * nFeatures + candidates[s * nFeatures + k]] = 1;
+		}
+		if (splitMode == SplitMode::Histogram) {
+			std::fill(rowSlot.begin(), rowSlot.end(), -1);
+			for (int s = 0; s < nOpen; ++s) {
+				const int* rows = rowsOf(open[s].begin);
+				for (int k = 0; k < open[s].end - open[s].begin; ++k) rowSlot[rows[k]] = s;
+			}
+		}
+		results.assign(static_cast<std::size_t>(nOpen) * nFeatures, SplitCandidate());
+
+		// one pass per feature column for the whole level
+		auto searchFeature = [&](int f, SplitScratch& buffers) {
+			if (splitMode != SplitMode::Histogram) {
+				for (int s = 0; s < nOpen; ++s) {
+					if (searched[static_cast<std::size_t>(s) * nFeatures + f] && stats[s].n >= minSampleSplit) {
+						results[static_cast<std::size_t>(s) * nFeatures + f] = scanExact(X, Y, f, open[s].begin, stats[s], buffers);
+					}
+				}
+				return;
+			}
+			const int nb = bins->getNBins(f);
+			if (nb < 2) return; // constant feature
+			auto& histCount = buffers.histCount;
+			auto& histClass = buffers.histClass;
+			auto& histSum = buffers.histSum;
+			auto& histSum2 = buffers.histSum2;
+			const std::uint8_t* col = bins->column(f);
+			const int perPass = std::max(1, kMaxLevelHistogramCells / (nb * (isClassification ? nClasses : 1)));
+			for (int first = 0; first < nOpen; first += perPass) {
+				const int last = std::min(nOpen, first + perPass);
+				const std::size_t cells = static_cast<std::size_t>(last - first) * nb;
+				if (histCount.size() < cells) histCount.resize(cells);
+				std::fill(histCount.begin(), histCount.begin() + cells, 0);
+				if (isClassification) {
+					if (histClass.size() < cells * nClasses) histClass.resize(cells * nClasses);
+					std::fill(histClass.begin(), histClass.begin() + cells * nClasses, 0);
+				} else {
+					if (histSum.size() < cells) {
+						histSum.resize(cells);
+						histSum2.resize(cells);
+					}
+					std::fill(histSum.begin(), histSum.begin() + cells, 0.0);
+					std::fill(histSum2.begin(), histSum2.begin() + cells, 0.0);
+				}
+				for (int i = 0; i < nSamples; ++i) {
+					const int s = rowSlot[i];
+					if (s < first || s >= last || !searched[static_cast<std::size_t>(s) * nFeatures + f]) continue;
+					const std::size_t cell = static_cast<std::size_t>(s - first) * nb + col[i];
+					histCount[cell] += weight[i];
+					if (isClassification) {
+						histClass[cell * nClasses + classIndex[i]] += weight[i];
+					} else {
+						const double y = Y[i];
+						histSum[cell] += weight[i] * y;
+						histSum2[cell] += hessian ? weight[i] * static_cast<double>(hessian[i]) : weight[i] * y * y;
+					}
+				}
+				for (int s = first; s < last; ++s) {
+					if (!searched[static_cast<std::size_t>(s) * nFeatures + f] || stats[s].n < minSampleSplit) continue;
+					const std::size_t at = static_cast<std::size_t>(s - first) * nb;
+					results[static_cast<std::size_t>(s) * nFeatures + f] = isClassification
+						? sweepHistogram(f, stats[s], histCount.data() + at, nullptr, nullptr, histClass.data() + at * nClasses, buffers)
+						: sweepHistogram(f, stats[s], histCount.data() + at, histSum.data() + at, histSum2.data() + at, nullptr, buffers);
+				}
+			}
+		};
+
+		const int tasks = splitInParallel(openRows * nFeatures) ? std::min(ThreadPool::resolveThreadCount(numThreads), nFeatures) : 1;
+		if (tasks == 1) {
+			typename ScratchPool::Lease lease(*scratch);
+			for (int f = 0; f < nFeatures; ++f) searchFeature(f, *lease);
+		} else {
+			ThreadPool::shared().parallelFor(0, tasks, [&](std::size_t t) {
+				typename ScratchPool::Lease lease(*scratch);
+				for (int f = static_cast<int>(t); f < nFeatures; f += tasks) searchFeature(f, *lease);
+			});
+		}
+
+		// every node keeps the first of its best candidates in its own feature order, then is partitioned like buildTree does
+		next.clear();
+		for (int s = 0; s < nOpen; ++s) {
+			SplitCandidate best;
+			for (int k = 0; k < nCandidates[s]; ++k) {
+				const SplitCandidate& c = results[static_cast<std::size_t>(s) * nFeatures + candidates[s * nFeatures + k]];
+				if (c.gain > best.gain) best = c;
+			}
+			const Frontier& fr = open[s];
+			if (best.feature == -1) {
+				makeLeaf(nodes, fr.node, fr.begin, fr.end, Y);
+				continue;
+			}
+			const Scalar thr = roundThreshold<Scalar>(best.threshold);
+			const int mid = partitionNode(X, best.feature, thr, fr.begin, fr.end);
+			const int lch = nodes.add();
+			const int rch = nodes.add();
+			nodes.feature[fr.node] = best.feature;
+			nodes.threshold[fr.node] = thr;
+			nodes.left[fr.node] = lch;
+			nodes.right[fr.node] = rch;
+			nodes.isLeaf[fr.node] = false;
+			next.push_back({lch, fr.begin, mid});
+			next.push_back({rch, mid, fr.end});
+		}
+		level.swap(next);
+	}
+}
 
+template <class Scalar>
+void BasicDecisionTree<Scalar>::fit(const std::vector<std::vector<double>>& X,
+                       const std::vector<double>& Y) {
 	if (X.empty() || Y.empty() || X.size() != Y.size()) {
         	throw std::invalid_argument("Fit: X and Y must be non-empty and have the same number of rows.");
     	}
+    	if (X[0].empty()) {
+        	throw std::invalid_argument("Fit: X must have at least one feature.");
+    	}
+	fit(FeatureMatrix(X), Y);
+}
+
+template <class Scalar>
+void BasicDecisionTree<Scalar>::fit(const FeatureMatrix& X,
+                       const std::vector<double>& Y,
+                       const std::vector<int>& sampleCounts) {
+	if constexpr (std::is_same<Scalar, double>::value) {
+		fit(X, Span<const double>(Y), sampleCounts);
+	} else {
+		const std::vector<Scalar> targets(Y.begin(), Y.end());
+		fit(X, Span<const Scalar>(targets), sampleCounts);
+	}
+}
+
+template <class Scalar>
+void BasicDecisionTree<Scalar>::fitGradients(const FeatureMatrix& X,
+                       Span<const Scalar> gradients,
+                       Span<const Scalar> hessians,
+                       const GradientParams& params,
+                       const std::vector<int>& sampleCounts) {
+	if (isClassification) {
+		throw std::logic_error("fitGradients: gradient trees are regression trees.");
+	}
+	if (hessians.size != gradients.size) {
+		throw std::invalid_argument("fitGradients: gradients and hessians must have the same size.");
+	}
+	if (params.lambda < 0.0 || params.alpha < 0.0 || params.gamma < 0.0 || params.minChildWeight < 0.0) {
+		throw std::invalid_argument("fitGradients: lambda, alpha, gamma and minChildWeight must be non-negative.");
+	}
+	gradientParams = params;
+	hessian = hessians.data;
+	try {
+		fit(X, gradients, sampleCounts);
+	} catch (...) {
+		hessian = nullptr;
+		throw;
+	}
+	hessian = nullptr;
+}
+
+// an empty sampleCounts means every row once
+template <class Scalar>
+void BasicDecisionTree<Scalar>::fit(const FeatureMatrix& X,
+                       Span<const Scalar> Y,
+                       const std::vector<int>& sampleCounts) {
+
+	if (X.rows() == 0 || Y.size == 0 || X.rows() != Y.size) {
+        	throw std::invalid_argument("Fit: X and Y must be non-empty and have the same number of rows.");
+    	}
+    	if (!sampleCounts.empty()) {
+    		if (sampleCounts.size() != Y.size) {
+    			throw std::invalid_argument("Fit: sampleCounts must have one entry per row.");
+    		}
+    		if (std::any_of(sampleCounts.begin(), sampleCounts.end(), [](int c) { return c < 0; }) ||
+    		    std::none_of(sampleCounts.begin(), sampleCounts.end(), [](int c) { return c > 0; })) {
+    			throw std::invalid_argument("Fit: sampleCounts must be non-negative with at least one sampled row.");
+    		}
+    	}
 
-    	nFeatures = static_cast<int>(X[0].size());
+    	nFeatures = static_cast<int>(X.cols());
     	if (nFeatures == 0) {
         	throw std::invalid_argument("Fit: X must have at least one feature.");
     	}
+    	if (leafValuesOut.data && leafValuesOut.size != X.rows()) {
+    		leafValuesOut = Span<Scalar>();
+    		throw std::invalid_argument("Fit: the leaf value output must have one entry per row.");
+    	}
     	// reset all storage
-    	feature.clear(); threshold.clear(); left.clear(); right.clear();
-    	isLeaf.clear(); value.clear(); sumY2.clear();
+    	nodes = NodeList();
     	nNodes = 0;
 
-    	int root = newNode();
-    	std::vector<int> idx(X.size());
+    	// encode labels into dense class ids once
+    	nClasses = 0;
+    	classLabels.clear();
+    	classIndex.clear();
+    	if (isClassification) {
+    		classLabels.assign(Y.begin(), Y.end());
+    		std::sort(classLabels.begin(), classLabels.end());
+    		classLabels.erase(std::unique(classLabels.begin(), classLabels.end()), classLabels.end());
+    		nClasses = static_cast<int>(classLabels.size());
+    		classIndex.resize(Y.size);
+    		for (std::size_t i = 0; i < Y.size; ++i) {
+    			classIndex[i] = static_cast<int>(std::lower_bound(classLabels.begin(), classLabels.end(), Y[i]) - classLabels.begin());
+    		}
+    	}
+
+    	if (splitMode == SplitMode::Histogram) {
+    		if (!bins || bins->getNRows() != static_cast<int>(X.rows()) || bins->getNFeatures() != nFeatures) {
+    			bins = std::make_shared<const FeatureBins>(X, maxBins);
+    		}
+    	}
+
+    	// one row buffer for the whole tree holding the sampled rows, nodes are [begin, end) ranges partitioned in place
+    	nSamples = static_cast<int>(X.rows());
+    	if (sampleCounts.empty()) weight.assign(nSamples, 1);
+    	else weight = sampleCounts;
+    	std::vector<int> sampled;
+    	sampled.reserve(nSamples);
+    	for (int i = 0; i < nSamples; ++i) {
+    		if (weight[i] > 0) sampled.push_back(i);
+    	}
+    	const int nSampled = static_cast<int>(sampled.size());
+
+    	goesLeft.assign(nSamples, 0);
+    	partitionScratch.assign(nSampled, 0);
+    	if (splitMode == SplitMode::Presorted) {
+    		// argsort every column once, ties ordered by row id
+    		presorted.resize(static_cast<std::size_t>(nFeatures) * nSamples);
+    		auto sortColumn = [&](std::size_t f) {
+    			int* seg = presorted.data() + f * nSamples;
+    			std::copy(sampled.begin(), sampled.end(), seg);
+    			std::sort(seg, seg + nSampled, [&X, f](int a, int b) {
+    				return X(a, f) < X(b, f) || (X(a, f) == X(b, f) && a < b);
+    			});
+    		};
+    		if (splitInParallel(static_cast<std::size_t>(nSampled) * nFeatures)) {
+    			ThreadPool::shared().parallelFor(0, nFeatures, sortColumn);
+    		} else {
+    			for (int f = 0; f < nFeatures; ++f) sortColumn(f);
+    		}
+    	} else {
+    		nodeRows = std::move(sampled);
+    	}
+    	const bool histogram = splitMode == SplitMode::Histogram;
+    	scratch = std::make_shared<ScratchPool>(histogram ? 0 : nSampled, histogram ? maxBins : 0, nClasses, isClassification);
 
-    	for (int i = 0; i < (int)X.size(); ++i) idx[i] = i;
+    	candidateFeatures.resize(nFeatures);
+    	std::iota(candidateFeatures.begin(), candidateFeatures.end(), 0);
 
-    	buildTree(X, Y, idx, /*depth=*/0, root);
+    	if (growth == TreeGrowth::LevelWise) {
+    		buildLevelWise(X, Y, nSampled);
+    	} else {
+    		int root = nodes.add();
+    		buildTree(X, Y, 0, nSampled, /*depth=*/0, nodes, root);
+    	}
+    	nNodes = nodes.size();
     	isFitted = true;
+
+    	// trees are stored by value in the ensembles, so drop the training scratch
+    	bins.reset();
+    	featureSampler = nullptr;
+    	leafValuesOut = Span<Scalar>();
+    	candidateFeatures = std::vector<int>();
+    	weight = std::vector<int>();
+    	classIndex = std::vector<int>();
+    	scratch.reset();
+    	nodeRows = std::vector<int>();
+    	presorted = std::vector<int>();
+    	goesLeft = std::vector<char>();
+    	partitionScratch = std::vector<int>();
+}
+
+template <class Scalar>
+void BasicDecisionTree<Scalar>::packInto(std::vector<PackedNode>& out, double scale) const {
+	if (!isFitted) {
+        	throw std::runtime_error("packInto: model not fitted.");
+    	}
+
+	// breadth-first order; the two children of a node are pushed together, so they end up adjacent
+	std::vector<int> order{0};
+	std::vector<std::uint32_t> position(nodes.feature.size(), 0);
+	for (std::size_t q = 0; q < order.size(); ++q) {
+		const int node = order[q];
+		position[node] = static_cast<std::uint32_t>(q);
+		if (!nodes.isLeaf[node]) {
+			order.push_back(nodes.left[node]);
+			order.push_back(nodes.right[node]);
+		}
+	}
+
+	const std::uint32_t base = static_cast<std::uint32_t>(out.size());
+	out.reserve(out.size() + order.size());
+	for (int node : order) {
+		if (nodes.isLeaf[node]) {
+			out.push_back(PackedNode::leaf(scale * nodes.value[node]));
+		} else {
+			out.push_back(PackedNode::split(nodes.feature[node], nodes.threshold[node], base + position[nodes.left[node]]));
+		}
+	}
 }
 
-double DecisionTree::predict(const std::vector<double>& x) const {
+template <class Scalar>
+double BasicDecisionTree<Scalar>::predict(const std::vector<double>& x) const {
 	if (!isFitted) {
         	throw std::runtime_error("predict: model not fitted.");
     	}
@@ -282,12 +954,32 @@ double DecisionTree::predict(const std::vector<double>& x) const {
         	throw std::invalid_argument("predict: feature dimension mismatch.");
     	}
 	int node = 0; // root
-	while (!isLeaf[node]) {
-		int f = feature[node];
-        	double thr = threshold[node];
-        	if (x[f] <= thr) node = left[node];
-        	else node = right[node];
+	while (!nodes.isLeaf[node]) {
+		int f = nodes.feature[node];
+        	double thr = nodes.threshold[node];
+        	if (x[f] <= thr) node = nodes.left[node];
+        	else node = nodes.right[node];
         	if (node < 0) break; // safety
     	}
-	return value[node < 0 ? 0 : node];
+	return nodes.value[node < 0 ? 0 : node];
 }
+
+// predict one row of a feature matrix without copying it into a vector
+template <class Scalar>
+double BasicDecisionTree<Scalar>::predict(const FeatureMatrix& X, std::size_t row) const {
+	if (!isFitted) {
+        	throw std::runtime_error("predict: model not fitted.");
+    	}
+	if (static_cast<int>(X.cols()) != nFeatures) {
+        	throw std::invalid_argument("predict: feature dimension mismatch.");
+    	}
+	int node = 0;
+	while (!nodes.isLeaf[node]) {
+		node = (X(row, nodes.feature[node]) <= nodes.threshold[node]) ? nodes.left[node] : nodes.right[node];
+		if (node < 0) break; // safety
+	}
+	return nodes.value[node < 0 ? 0 : node];
+}
+
+template class BasicDecisionTree<float>;
+template class BasicDecisionTree<double>;
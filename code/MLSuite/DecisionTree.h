@@ -3,38 +3,178 @@
 
 #include <vector>
 #include <tuple>
-class DecisionTree
+#include <utility>
+#include <memory>
+#include <functional>
+#include <type_traits>
+#include "FeatureBins.h"
+#include "FeatureMatrix.h"
+#include "PackedForest.h"
+
+// Exact sorts the node's rows per feature and tries every midpoint, Histogram scans the boundaries of
+// features quantized once per fit (see FeatureBins), Presorted argsorts every feature once per fit and
+// keeps each node's segment sorted by stable partitioning (SLIQ/SPRINT style, same splits as Exact).
+enum class SplitMode { Exact, Histogram, Presorted };
+
+// DepthFirst grows one node at a time recursively, LevelWise grows a whole depth at once: each feature column is read
+// in one pass for all frontier nodes (one histogram per node, or the per-node sorted sweeps back to back). Both grow
+// the same tree from the same split rules; only the order of the feature sampler calls differs.
+enum class TreeGrowth { DepthFirst, LevelWise };
+
+// second-order boosting objective of BasicDecisionTree::fitGradients (XGBoost): with G, H the gradient and hessian sums
+// of a node and T(G) = sign(G) * max(|G| - alpha, 0), a split gains
+// 0.5 * [T(GL)^2 / (HL + lambda) + T(GR)^2 / (HR + lambda) - T(G)^2 / (H + lambda)] - gamma and a leaf weighs -T(G) / (H + lambda),
+// clamped to [-maxDeltaStep, maxDeltaStep] when maxDeltaStep > 0
+struct GradientParams {
+	double lambda = 1.0;         // L2 penalty on leaf weights
+	double alpha = 0.0;          // L1 penalty on leaf weights
+	double gamma = 0.0;          // minimum gain of a split
+	double minChildWeight = 1.0; // minimum hessian sum of each child
+	double maxDeltaStep = 0.0;   // largest leaf weight magnitude, 0 for no limit
+};
+
+// called once per node to pick the features whose splits are evaluated there; fills features with distinct ids in [0, nFeatures)
+using FeatureSampler = std::function<void(int nFeatures, std::vector<int>& features)>;
+
+// The tree models are templates on Scalar, the precision of their targets, thresholds and leaf values: float keeps
+// the whole path from Dataset to prediction in float32 (half the bytes read per row while splitting), double matches
+// the historical float64 trees. Features are float32 (FeatureMatrix) either way, and row sums are accumulated in double.
+template <class Scalar>
+class BasicDecisionTree
 {
+	static_assert(std::is_floating_point<Scalar>::value, "BasicDecisionTree: Scalar must be float or double");
+
 private:
+	// node storage, children are indices into the same arrays
+	struct NodeList {
+		std::vector<int> feature;
+		std::vector<Scalar> threshold;
+		std::vector<int> left;
+		std::vector<int> right;
+		std::vector<char> isLeaf;
+		std::vector<Scalar> value;
+
+		int add();
+		int size() const { return static_cast<int>(feature.size()); }
+		// copies the root of sub into node at and appends the rest of sub, so ids match a serial depth-first build
+		void graft(int at, const NodeList& sub);
+	};
+
+	// per-task buffers of the split search, handed out by a ScratchPool so concurrent features and subtrees never share one
+	struct SplitScratch {
+		std::vector<std::pair<float, int>> sorted; // (x_f, row) of the node being swept
+		std::vector<int> histCount;               // per-bin counts
+		std::vector<double> histSum, histSum2;
+		std::vector<int> histClass;               // nBins * nClasses class counts
+		std::vector<int> countsL, countsR;        // class counts left and right of the sweep, majority votes
+	};
+	class ScratchPool;
+
+	// best split of one feature (threshold before rounding to Scalar), gain 0 when it has none
+	struct SplitCandidate {
+		double gain = 0.0;
+		int feature = -1;
+		double threshold = 0.0;
+	};
+
+	// statistics of the node being split, shared read-only by the features searched in parallel
+	struct NodeStats {
+		int m = 0; // distinct rows
+		int n = 0; // rows counted with their weights
+		double sumP = 0.0, sumP2 = 0.0;
+		std::vector<int> countsP;
+		double sqP = 0.0, giniP = 0.0;
+	};
+
 	int maxDepth;
 	int minSampleSplit;
     	bool isClassification;
 	int nNodes;
     	int nFeatures;
     	bool isFitted;
-    	std::vector<int> feature;
-    	std::vector<double> threshold;
-    	std::vector<int> left;
-    	std::vector<int> right;
-    	std::vector<bool> isLeaf;
-    	std::vector<double> value;
-    	double sumY = 0.0;
-    	std::vector<double> sumY2;
-    	void buildTree(const std::vector<std::vector<double>>& X,const std::vector<double>& Y,const std::vector<int>& indices, int depth, int nodeIndex);
-    	std::tuple<int, double, double, std::vector<int>, std::vector<int>> bestSplit(const std::vector<std::vector<double>>& X,const std::vector<double>& Y,const std::vector<int>& indices);
-    	double computeMSE(int n, double sum, double sum2);
-        double computeGini(const std::vector<int>& indices, const std::vector<double>& Y);
-    	double impurityDecrease(int nP, double sumP, double sumP2, int nL, double sumL, double sumL2, int nR, double sumR, double sumR2,
-                              const std::vector<int>& indicesP, const std::vector<int>& indicesL, const std::vector<int>& indicesR, const std::vector<double>& Y);
-    	void makeLeaf(int nodeIndex,const std::vector<int>& indicies, const std::vector<double>& Y);
-    	std::tuple<std::vector<int>, std::vector<int>> partitionByThreshold(const std::vector<std::vector<double>>& X, int feat, double thr,const std::vector<int>& indicies);
-    	int newNode();
+    	SplitMode splitMode = SplitMode::Exact;
+    	TreeGrowth growth = TreeGrowth::DepthFirst;
+    	int maxBins = FeatureBins::kMaxBins;
+    	int numThreads = 1;
+    	NodeList nodes;
+
+    	// training-only state, released at the end of fit
+    	std::shared_ptr<const FeatureBins> bins;
+    	std::vector<int> weight;           // multiplicity of every training row (bootstrap counts), 0 rows are left out
+    	FeatureSampler featureSampler;
+    	Span<Scalar> leafValuesOut;        // leaf value of every sampled training row, written as the leaves are made
+    	std::vector<int> candidateFeatures; // features searched at the current node
+    	int nClasses = 0;
+    	std::vector<Scalar> classLabels;   // sorted distinct labels, class id -> label
+    	std::vector<int> classIndex;       // class id per training row
+    	const Scalar* hessian = nullptr;   // fitGradients: per-row hessians, node sums then hold (G, H) instead of (sum y, sum y^2)
+    	GradientParams gradientParams;
+    	std::shared_ptr<ScratchPool> scratch;
+    	int nSamples = 0;
+    	std::vector<int> nodeRows;         // row ids, each node owns a contiguous [begin, end) range
+    	std::vector<int> presorted;        // Presorted: nFeatures segments of nSamples row ids, node ranges sorted per feature
+    	std::vector<char> goesLeft;        // per row side of the split being applied
+    	std::vector<int> partitionScratch; // right-hand rows while a range is partitioned, at the range's own offset
+
+    	void buildTree(const FeatureMatrix& X, Span<const Scalar> Y, int begin, int end, int depth, NodeList& out, int nodeIndex);
+    	void buildLevelWise(const FeatureMatrix& X, Span<const Scalar> Y, int nSampled);
+    	NodeStats nodeStats(Span<const Scalar> Y, int begin, int end) const;
+    	std::tuple<int, Scalar, double> bestSplit(const FeatureMatrix& X, Span<const Scalar> Y, int begin, int end);
+    	SplitCandidate scanExact(const FeatureMatrix& X, Span<const Scalar> Y, int f, int begin, const NodeStats& node, SplitScratch& buffers) const;
+    	SplitCandidate scanHistogram(Span<const Scalar> Y, int f, int begin, const NodeStats& node, SplitScratch& buffers) const;
+    	// boundary sweep over one node's filled histogram of feature f (classCounts nBins * nClasses for classification)
+    	SplitCandidate sweepHistogram(int f, const NodeStats& node, const int* count, const double* sum, const double* sum2,
+    	                              const int* classCounts, SplitScratch& buffers) const;
+    	double computeMSE(int n, double sum, double sum2) const;
+    	double impurityDecrease(int nP, double sumP, double sumP2, int nL, double sumL, double sumL2, int nR, double sumR, double sumR2) const;
+    	double giniDecrease(int nP, double giniP, int nL, double sqL, int nR, double sqR) const;
+    	double newtonGain(double gP, double hP, double gL, double hL, double gR, double hR) const;
+    	double leafWeight(double g, double h) const;
+    	void makeLeaf(NodeList& out, int nodeIndex, int begin, int end, Span<const Scalar> Y);
+    	const int* rowsOf(int begin) const;
+    	int partitionNode(const FeatureMatrix& X, int feat, Scalar thr, int begin, int end);
+    	int nodeWeight(int begin, int end) const;
+    	bool splitInParallel(std::size_t work) const;
+    	bool growSiblingsInParallel(int depth, int rows) const;
 
 public:
-    	DecisionTree(int maxDepth, int minSampleSplit = 2, bool isClassification = false);
+    	BasicDecisionTree(int maxDepth, int minSampleSplit = 2, bool isClassification = false);
+    	// row i of X counts sampleCounts[i] times (every row once when empty), so a bootstrap sample needs no copy of X
+    	void fit(const FeatureMatrix& X, Span<const Scalar> Y, const std::vector<int>& sampleCounts = std::vector<int>());
+    	// float64 targets, converted to Scalar once
+    	void fit(const FeatureMatrix& X, const std::vector<double>& Y, const std::vector<int>& sampleCounts = std::vector<int>());
     	void fit(const std::vector<std::vector<double>>& X, const std::vector<double>& Y);
+    	// regression tree on the loss gradients and hessians of every row (second-order boosting), see GradientParams
+    	void fitGradients(const FeatureMatrix& X, Span<const Scalar> gradients, Span<const Scalar> hessians,
+    	                  const GradientParams& params, const std::vector<int>& sampleCounts = std::vector<int>());
     	double predict(const std::vector<double>& x) const;
+    	double predict(const FeatureMatrix& X, std::size_t row) const;
     	int getNNodes() const { return nNodes; }
+    	// appends the tree to a packed node array in breadth-first order, leaf values multiplied by scale
+    	void packInto(std::vector<PackedNode>& out, double scale = 1.0) const;
+
+    	void setSplitMode(SplitMode mode) { splitMode = mode; }
+    	void setGrowth(TreeGrowth order) { growth = order; }
+    	void setMaxBins(int bins);
+    	SplitMode getSplitMode() const { return splitMode; }
+    	TreeGrowth getGrowth() const { return growth; }
+    	int getMaxBins() const { return maxBins; }
+    	// bins of the same X for the next Histogram fit, so an ensemble quantizes its data once
+    	void setFeatureBins(std::shared_ptr<const FeatureBins> shared) { bins = std::move(shared); }
+    	// per node feature subset for the next fit (random forests), every feature when unset
+    	void setFeatureSampler(FeatureSampler sampler) { featureSampler = std::move(sampler); }
+    	// for the next fit, out[i] receives the value of the leaf training row i ends up in, so boosting can update its
+    	// predictions without traversing the tree again; one entry per row of X, rows with sampleCount 0 are left as they are
+    	void setLeafValueOutput(Span<Scalar> out) { leafValuesOut = out; }
+
+    	// threads for one fit (<= 0 uses every hardware thread): the features of large nodes are searched in parallel on
+    	// ThreadPool::shared() and, without a feature sampler, sibling subtrees near the root grow concurrently. The tree
+    	// does not depend on it.
+    	void setNumThreads(int threads) { numThreads = threads; }
+    	int getNumThreads() const { return numThreads; }
 };
 
+using DecisionTree = BasicDecisionTree<float>;
+using DecisionTree64 = BasicDecisionTree<double>;
+
 #endif 
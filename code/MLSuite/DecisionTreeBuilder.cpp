@@ -2,7 +2,7 @@
 #include <stdexcept> // error handling 
 
 DecisionTreeBuilder::DecisionTreeBuilder() 
-    : mMaxDepth(10), mMinSamplesSplit(2), mIsClassification(false) {}
+    : mMaxDepth(10), mMinSamplesSplit(2), mIsClassification(false), mSplitMode(SplitMode::Exact), mGrowth(TreeGrowth::DepthFirst), mMaxBins(FeatureBins::kMaxBins), mNumThreads(1) {}
 
 DecisionTreeBuilder& DecisionTreeBuilder::setMaxDepth(int maxDepth) {
     if (maxDepth <= 0) {
@@ -25,6 +25,38 @@ DecisionTreeBuilder& DecisionTreeBuilder::setIsClassification(bool isClassificat
     return *this;
 }
 
-std::unique_ptr<DecisionTree> DecisionTreeBuilder::build() {
-    return std::make_unique<DecisionTree>(mMaxDepth, mMinSamplesSplit, mIsClassification);
+DecisionTreeBuilder& DecisionTreeBuilder::setSplitMode(SplitMode splitMode) {
+    mSplitMode = splitMode;
+    return *this;
+}
+
+DecisionTreeBuilder& DecisionTreeBuilder::setGrowth(TreeGrowth growth) {
+    mGrowth = growth;
+    return *this;
+}
+
+DecisionTreeBuilder& DecisionTreeBuilder::setMaxBins(int maxBins) {
+    if (maxBins < 2 || maxBins > FeatureBins::kMaxBins) {
+        throw std::invalid_argument("maxBins must be in [2, 256].");
+    }
+    mMaxBins = maxBins;
+    return *this;
+}
+
+DecisionTreeBuilder& DecisionTreeBuilder::setNumThreads(int numThreads) {
+    mNumThreads = numThreads;
+    return *this;
 }
+
+template <class Scalar>
+std::unique_ptr<BasicDecisionTree<Scalar>> DecisionTreeBuilder::build() {
+    auto tree = std::make_unique<BasicDecisionTree<Scalar>>(mMaxDepth, mMinSamplesSplit, mIsClassification);
+    tree->setSplitMode(mSplitMode);
+    tree->setGrowth(mGrowth);
+    tree->setMaxBins(mMaxBins);
+    tree->setNumThreads(mNumThreads);
+    return tree;
+}
+
+template std::unique_ptr<DecisionTree> DecisionTreeBuilder::build<float>();
+template std::unique_ptr<DecisionTree64> DecisionTreeBuilder::build<double>();
@@ -10,13 +10,23 @@ public:
     DecisionTreeBuilder& setMaxDepth(int maxDepth);
     DecisionTreeBuilder& setMinSamplesSplit(int minSamplesSplit);
     DecisionTreeBuilder& setIsClassification(bool isClassification);
+    DecisionTreeBuilder& setSplitMode(SplitMode splitMode);
+    DecisionTreeBuilder& setGrowth(TreeGrowth growth);
+    DecisionTreeBuilder& setMaxBins(int maxBins);
+    DecisionTreeBuilder& setNumThreads(int numThreads);
 
-    std::unique_ptr<DecisionTree> build();
+    // float32 tree by default, build<double>() for a float64 one
+    template <class Scalar = float>
+    std::unique_ptr<BasicDecisionTree<Scalar>> build();
 
 private:
     int mMaxDepth;
     int mMinSamplesSplit;
     bool mIsClassification;
+    SplitMode mSplitMode;
+    TreeGrowth mGrowth;
+    int mMaxBins;
+    int mNumThreads;
 };
 
 #endif // DECISIONTREEBUILDER_H
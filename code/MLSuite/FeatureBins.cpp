@@ -0,0 +1,72 @@
+#include "FeatureBins.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace {
+	// cut points for one column: every boundary between distinct values when they fit in maxBins,
+	// otherwise boundaries at (count weighted) quantiles so each bin holds roughly n / maxBins rows
+	std::vector<double> computeCuts(std::vector<float> values, int maxBins) {
+		std::sort(values.begin(), values.end());
+
+		std::vector<float> distinct;
+		std::vector<int> counts;
+		for (float v : values) {
+			if (distinct.empty() || v != distinct.back()) {
+				distinct.push_back(v);
+				counts.push_back(1);
+			} else {
+				++counts.back();
+			}
+		}
+
+		std::vector<double> cuts;
+		if (distinct.size() <= 1) return cuts;
+
+		if (static_cast<int>(distinct.size()) <= maxBins) {
+			cuts.reserve(distinct.size() - 1);
+			for (std::size_t i = 0; i + 1 < distinct.size(); ++i) {
+				cuts.push_back(0.5 * (static_cast<double>(distinct[i]) + distinct[i + 1])); // same midpoint the exact sweep would use
+			}
+			return cuts;
+		}
+
+		const double perBin = static_cast<double>(values.size()) / maxBins;
+		double next = perBin;
+		int seen = 0;
+		for (std::size_t i = 0; i + 1 < distinct.size() && static_cast<int>(cuts.size()) < maxBins - 1; ++i) {
+			seen += counts[i];
+			if (seen >= next) {
+				cuts.push_back(0.5 * (static_cast<double>(distinct[i]) + distinct[i + 1]));
+				next = seen + perBin;
+			}
+		}
+		return cuts;
+	}
+}
+
+FeatureBins::FeatureBins(const FeatureMatrix& X, int maxBins) {
+	if (maxBins < 2 || maxBins > kMaxBins) {
+		throw std::invalid_argument("FeatureBins: maxBins must be in [2, 256].");
+	}
+	if (X.empty()) {
+		throw std::invalid_argument("FeatureBins: X must be non-empty.");
+	}
+
+	nRows = static_cast<int>(X.rows());
+	const int nFeatures = static_cast<int>(X.cols());
+	cuts.resize(nFeatures);
+	codes.resize(static_cast<std::size_t>(nFeatures) * nRows);
+
+	std::vector<float> col(nRows);
+	for (int f = 0; f < nFeatures; ++f) {
+		for (int i = 0; i < nRows; ++i) col[i] = X(i, f);
+		cuts[f] = computeCuts(col, maxBins);
+
+		std::uint8_t* out = codes.data() + static_cast<std::size_t>(f) * nRows;
+		const std::vector<double>& c = cuts[f];
+		for (int i = 0; i < nRows; ++i) {
+			// number of cuts strictly below x, so x == cut[b] lands in bin b (left side of that cut)
+			out[i] = static_cast<std::uint8_t>(std::lower_bound(c.begin(), c.end(), col[i]) - c.begin());
+		}
+	}
+}
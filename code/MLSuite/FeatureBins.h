@@ -0,0 +1,35 @@
+#ifndef FEATUREBINS_H
+#define FEATUREBINS_H
+
+#include <cstdint>
+#include <vector>
+#include "FeatureMatrix.h"
+
+// FeatureBins quantizes every feature column into at most maxBins ordinal bins once per fit, so histogram split
+// finding only has to scan bin boundaries at each node instead of re-sorting the raw feature values.
+// Bin b of feature f holds the values in (cut(f, b - 1), cut(f, b)], which matches the "x <= threshold goes left" rule.
+class FeatureBins {
+public:
+	static constexpr int kMaxBins = 256; // bin ids are stored as uint8_t
+
+	FeatureBins() = default;
+	FeatureBins(const FeatureMatrix& X, int maxBins = kMaxBins);
+
+	int getNRows() const { return nRows; }
+	int getNFeatures() const { return static_cast<int>(cuts.size()); }
+	int getNBins(int feature) const { return static_cast<int>(cuts[feature].size()) + 1; }
+
+	// bin id of every row for one feature, contiguous so a node can stream through it
+	const std::uint8_t* column(int feature) const { return codes.data() + static_cast<std::size_t>(feature) * nRows; }
+	std::uint8_t bin(int row, int feature) const { return column(feature)[row]; }
+
+	// threshold separating bin and bin + 1 of a feature
+	double cut(int feature, int bin) const { return cuts[feature][bin]; }
+
+private:
+	int nRows = 0;
+	std::vector<std::uint8_t> codes;         // feature-major, nFeatures * nRows bin ids
+	std::vector<std::vector<double>> cuts;   // ascending thresholds per feature, getNBins(f) - 1 of them
+};
+
+#endif
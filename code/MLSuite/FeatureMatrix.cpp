@@ -0,0 +1,64 @@
+#include "FeatureMatrix.h"
+#include "Dataset.h"
+#include <stdexcept>
+
+FeatureMatrix::FeatureMatrix(const std::vector<std::vector<double>>& rowValues) {
+	if (rowValues.empty()) return;
+
+	const std::size_t n = rowValues.size();
+	const std::size_t p = rowValues[0].size();
+	std::vector<float> values(n * p);
+	for (std::size_t i = 0; i < n; ++i) {
+		if (rowValues[i].size() != p) {
+			throw std::invalid_argument("FeatureMatrix: inconsistent feature dimensions in rows");
+		}
+		for (std::size_t j = 0; j < p; ++j) {
+			values[j * n + i] = static_cast<float>(rowValues[i][j]);
+		}
+	}
+	*this = fromColumnMajor(std::move(values), n, p);
+}
+
+FeatureMatrix::FeatureMatrix(const float* rowMajor, std::size_t rowCount, std::size_t colCount, std::size_t stride)
+	: base(rowMajor), nRows(rowCount), nCols(colCount), rowStride(stride == 0 ? colCount : stride), colStride(1) {}
+
+FeatureMatrix::FeatureMatrix(const MatrixView& view)
+	: base(view.data), nRows(view.rows), nCols(view.cols), rowStride(view.stride), colStride(view.colStride) {}
+
+FeatureMatrix::FeatureMatrix(const std::vector<float>& rowMajor, std::size_t colCount) {
+	if (colCount == 0 || rowMajor.size() % colCount != 0) {
+		throw std::invalid_argument("FeatureMatrix: buffer size is not a multiple of the number of columns");
+	}
+	*this = FeatureMatrix(rowMajor.data(), rowMajor.size() / colCount, colCount);
+}
+
+// the row-major data, or the columns of a mapped binary file read in place
+FeatureMatrix::FeatureMatrix(const Dataset& dataset)
+	: FeatureMatrix(dataset.view()) {}
+
+FeatureMatrix FeatureMatrix::fromColumnMajor(std::vector<float> values, std::size_t rowCount, std::size_t colCount) {
+	if (values.size() != rowCount * colCount) {
+		throw std::invalid_argument("FeatureMatrix: buffer size does not match rows * cols");
+	}
+	FeatureMatrix m;
+	auto owned = std::make_shared<const std::vector<float>>(std::move(values));
+	m.base = owned->data();
+	m.storage = std::move(owned);
+	m.nRows = rowCount;
+	m.nCols = colCount;
+	m.rowStride = 1;
+	m.colStride = rowCount;
+	return m;
+}
+
+FeatureMatrix FeatureMatrix::gatherRows(const std::vector<int>& rowIndices) const {
+	const std::size_t n = rowIndices.size();
+	std::vector<float> values(n * nCols);
+	for (std::size_t j = 0; j < nCols; ++j) {
+		float* out = values.data() + j * n;
+		for (std::size_t k = 0; k < n; ++k) {
+			out[k] = (*this)(static_cast<std::size_t>(rowIndices[k]), j);
+		}
+	}
+	return fromColumnMajor(std::move(values), n, nCols);
+}
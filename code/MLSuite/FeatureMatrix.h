@@ -0,0 +1,60 @@
+#ifndef FEATUREMATRIX_H
+#define FEATUREMATRIX_H
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+#include "MatrixView.h"
+
+class Dataset;
+
+// FeatureMatrix is the float32 feature view read directly by the tree models (DecisionTree, RandomForest, XGBoostModel).
+// It either owns a contiguous column-major buffer, or borrows a MatrixView such as Dataset::view() (row-major values, or
+// the mapped columns of a binary Dataset) without copying it; element (i, j) is base[i * rowStride + j * colStride] in
+// every case. Copies are cheap, owned storage is shared, and a borrowed buffer must outlive every view of it.
+class FeatureMatrix {
+public:
+	FeatureMatrix() = default;
+
+	// owning, column-major copy of a jagged row matrix
+	explicit FeatureMatrix(const std::vector<std::vector<double>>& rows);
+
+	// non-owning view over a row-major buffer of nRows rows, rowStride values apart (nCols when 0)
+	FeatureMatrix(const float* rowMajor, std::size_t nRows, std::size_t nCols, std::size_t rowStride = 0);
+	explicit FeatureMatrix(const MatrixView& view);
+	FeatureMatrix(const std::vector<float>& rowMajor, std::size_t nCols);
+	FeatureMatrix(std::vector<float>&&, std::size_t) = delete; // a temporary would leave the view dangling
+
+	// non-owning view over a Dataset's data (its mapped columns when is_mapped()), one column per entry of get_columns()
+	explicit FeatureMatrix(const Dataset& dataset);
+	explicit FeatureMatrix(Dataset&&) = delete;
+
+	// owning matrix over values already laid out column by column
+	static FeatureMatrix fromColumnMajor(std::vector<float> values, std::size_t nRows, std::size_t nCols);
+
+	std::size_t rows() const { return nRows; }
+	std::size_t cols() const { return nCols; }
+	bool empty() const { return nRows == 0 || nCols == 0; }
+	bool isColumnMajor() const { return rowStride == 1; }
+
+	float operator()(std::size_t row, std::size_t col) const { return base[row * rowStride + col * colStride]; }
+
+	// writes the cols() values of one row to out
+	void copyRow(std::size_t row, float* out) const {
+		const float* first = base + row * rowStride;
+		for (std::size_t j = 0; j < nCols; ++j) out[j] = first[j * colStride];
+	}
+
+	// owning column-major copy of the selected rows, in the given order
+	FeatureMatrix gatherRows(const std::vector<int>& rowIndices) const;
+
+private:
+	std::shared_ptr<const std::vector<float>> storage; // set when the matrix owns its values
+	const float* base = nullptr;
+	std::size_t nRows = 0;
+	std::size_t nCols = 0;
+	std::size_t rowStride = 0;
+	std::size_t colStride = 0;
+};
+
+#endif
@@ -3,10 +3,12 @@
 
 #include "IModel.h"
 #include "BenchmarkStrategy.h" // Required for strategy pattern
+#include "MatrixView.h"
 #include <memory>
 #include <vector>
 #include <string>
 #include <functional>
+#include <stdexcept>
 
 class HyperparameterSearch {
 public:
@@ -14,14 +16,39 @@ public:
 
     virtual ~HyperparameterSearch() = default;
 
-    // random search is a pure virtual function, so all the derived classes must implement, in this case only classic model factory
+    // random search is a pure virtual function, so all the derived classes must implement, in this case only classic model factory.
+    // X is read in place (e.g. Dataset::view()), with one row per target in y
     virtual std::unique_ptr<IModel> randomSearch(
+        const std::string& modelType,
+        const std::vector<std::vector<std::string>>& hyperParams,
+        const MatrixView& X,
+        Span<const float> y,
+        const BenchmarkStrategy& evaluationStrategy,
+        const LogFn& log) = 0;
+
+    // jagged double rows, flattened once to float32 for the view overload
+    std::unique_ptr<IModel> randomSearch(
         const std::string& modelType,
         const std::vector<std::vector<std::string>>& hyperParams,
         const std::vector<std::vector<double>>& X,
         const std::vector<double>& y,
         const BenchmarkStrategy& evaluationStrategy,
-        const LogFn& log) = 0;
+        const LogFn& log = [](const std::string&) {}) {
+        if (X.empty() || y.empty() || X.size() != y.size()) {
+            throw std::invalid_argument("randomSearch: X and y must be non-empty and have matching sizes.");
+        }
+        const std::size_t nCols = X[0].size();
+        std::vector<float> values;
+        values.reserve(X.size() * nCols);
+        for (const auto& row : X) {
+            if (row.size() != nCols) {
+                throw std::invalid_argument("randomSearch: inconsistent feature row sizes.");
+            }
+            values.insert(values.end(), row.begin(), row.end());
+        }
+        const std::vector<float> targets(y.begin(), y.end());
+        return randomSearch(modelType, hyperParams, MatrixView(values.data(), X.size(), nCols), targets, evaluationStrategy, log);
+    }
 };
 
 #endif
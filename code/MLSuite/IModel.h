@@ -3,6 +3,10 @@
 
 #include <vector>
 #include <string>
+#include <atomic>
+#include <algorithm>
+#include <stdexcept>
+#include "MatrixView.h"
 
 // IModel is a common interface for the benchmark class to use and ensure consistent behavior across all types of models
 // so we do not have to modify benchmark for each model type with the IModel interface, as long as the model can use fit() and predict().
@@ -20,6 +24,33 @@ public:
 
     	// Method to get the name of the model (used by benchmark)
     	virtual std::string getName() const = 0;
+
+    	// zero-copy fit over a strided view; y holds one target per row (or a one-hot row per row where supported)
+    	virtual void fitView(const MatrixView& X, Span<const float> y) {
+    		fit(X.toVector(), std::vector<std::string>(X.cols), std::vector<float>(y.begin(), y.end()));
+    	}
+
+    	// predictions for every row of X written to out (out.size == X.rows); the models override this without
+    	// heap allocations, the default goes through the vector predict
+    	virtual void predictInto(const MatrixView& X, Span<float> out) const {
+    		if (out.size != X.rows) {
+    			throw std::invalid_argument("predictInto: output size must match the number of rows.");
+    		}
+    		std::vector<float> predictions = predict(X.toVector(), std::vector<std::string>(X.cols));
+    		if (predictions.size() != out.size) {
+    			throw std::runtime_error("predictInto: model returned the wrong number of predictions.");
+    		}
+    		std::copy(predictions.begin(), predictions.end(), out.begin());
+    	}
+
+    	// threads used by batch predict: the model's own setting, or the global default when it is 0
+    	void setPredictThreads(int threads) { predictThreads = threads; }
+    	int getPredictThreads() const { return predictThreads > 0 ? predictThreads : defaultPredictThreads.load(); }
+    	static void setDefaultPredictThreads(int threads) { defaultPredictThreads = threads > 0 ? threads : 1; }
+
+protected:
+    	int predictThreads = 0;
+    	inline static std::atomic<int> defaultPredictThreads{1};
 };
 
 #endif 
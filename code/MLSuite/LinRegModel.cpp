@@ -3,18 +3,46 @@
 #include <Eigen/Dense>
 #include <vector>
 #include <stdexcept>
+#include "ThreadPool.h"
 
-LinRegModel::LinRegModel() {}
+namespace {
+	// MatrixView as an Eigen matrix, rows X.stride and columns X.colStride floats apart (row-major or mapped columns)
+	using StridedView = Eigen::Map<const Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>, 0, Eigen::Stride<Eigen::Dynamic, Eigen::Dynamic>>;
+
+	StridedView asEigen(const MatrixView& X) {
+		return StridedView(X.data, static_cast<Eigen::Index>(X.rows), static_cast<Eigen::Index>(X.cols),
+		                   Eigen::Stride<Eigen::Dynamic, Eigen::Dynamic>(static_cast<Eigen::Index>(X.stride), static_cast<Eigen::Index>(X.colStride)));
+	}
+
+	// theta = (X_b^T X_b + ridge * I')^-1 X_b^T y, where X_b is X with a leading column of ones and I' leaves the bias
+	// unpenalized. X_b^T X_b is assembled from n, the column sums and X^T X, so the bias column is never materialized.
+	Eigen::VectorXf solveNormalEquations(const MatrixView& X_view, Span<const float> y_values, float ridge) {
+		const Eigen::Index n_rows = static_cast<Eigen::Index>(X_view.rows);
+		const Eigen::Index n_cols = static_cast<Eigen::Index>(X_view.cols);
+		StridedView X = asEigen(X_view);
+		Eigen::Map<const Eigen::VectorXf> y(y_values.data, n_rows);
+
+		Eigen::MatrixXf gram(n_cols + 1, n_cols + 1);
+		gram(0, 0) = static_cast<float>(n_rows);
+		gram.block(1, 0, n_cols, 1) = X.colwise().sum().transpose();
+		gram.block(0, 1, 1, n_cols) = gram.block(1, 0, n_cols, 1).transpose();
+		gram.bottomRightCorner(n_cols, n_cols).noalias() = X.transpose() * X;
+		gram.diagonal().tail(n_cols).array() += ridge;
+
+		Eigen::VectorXf rhs(n_cols + 1);
+		rhs(0) = y.sum();
+		rhs.tail(n_cols).noalias() = X.transpose() * y;
+		return gram.ldlt().solve(rhs);
+	}
+}
 
-void LinRegModel::fit(Dataset& X_dataset, Dataset& y_dataset, const std::string& regularization, double lambda) { 
-    	std::vector<float> x_data = X_dataset.get_data();
-    	std::vector<std::string> x_columns = X_dataset.get_columns();
-    	int n_cols_x = x_columns.size();
-    	int n_rows = x_data.size() / n_cols_x;
+LinRegModel::LinRegModel() {}
 
-	std::vector<float> y_data = y_dataset.get_data();
+void LinRegModel::fit(const Dataset& X_dataset, const Dataset& y_dataset, const std::string& regularization, double lambda) { 
+    	const MatrixView X = X_dataset.view();
+    	Span<const float> y = y_dataset.values();
 
-    	if (y_data.size() != n_rows) {
+    	if (y.size != X.rows) {
         	throw std::invalid_argument("Number of rows in X and y datasets do not match.");
     	}
 
@@ -22,22 +50,13 @@ void LinRegModel::fit(Dataset& X_dataset, Dataset& y_dataset, const std::string&
 		throw std::invalid_argument("Invalid regularization type");
 
 	}
-	
-    	Eigen::Map<Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>> X(x_data.data(), n_rows, n_cols_x);
-    	Eigen::Map<Eigen::VectorXf> y(y_data.data(), n_rows);
-
-    	Eigen::MatrixXf X_b(n_rows, n_cols_x + 1);
-    	X_b.setOnes();
-    	X_b.rightCols(n_cols_x) = X;
 
     	if (regularization == "L2") {
-        	Eigen::MatrixXf I = Eigen::MatrixXf::Identity(n_cols_x + 1, n_cols_x + 1);
-        	I(0, 0) = 0; // exclude bias 
-        	m_theta = (X_b.transpose() * X_b + lambda * I).ldlt().solve(X_b.transpose() * y);
+        	m_theta = solveNormalEquations(X, y, static_cast<float>(lambda));
     	} else if (regularization == "L1") {
         	throw std::logic_error("L1 regularization requires an iterative solver and is not supported by this method.");
     	} else { // "None" or any other value
-        	m_theta = (X_b.transpose() * X_b).ldlt().solve(X_b.transpose() * y);
+        	m_theta = solveNormalEquations(X, y, 0.0f);
     	}
 }
 
@@ -66,21 +85,18 @@ void LinRegModel::fit(const std::vector<float>& x_values, const std::vector<std:
     	if (x_values.size() % n_cols != 0) {
         	throw std::invalid_argument("The size of x_values is not a multiple of the number of columns.");
     	}
-    	if (n_rows != y_values.size()) {
+    	fitView(MatrixView(x_values.data(), n_rows, n_cols), y_values);
+}
+
+void LinRegModel::fitView(const MatrixView& X_view, Span<const float> y_values) {
+	if (X_view.empty() || y_values.size == 0) {
+        	throw std::invalid_argument("Input vectors cannot be empty.");
+    	}
+    	if (X_view.rows != y_values.size) {
     		throw std::invalid_argument("Number of samples in features and targets do not match.");
     	}
 
-    	// map the 1D float vector to an Eigen Matrix
-    	Eigen::Map<const Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>> X(x_values.data(), n_rows, n_cols);
-
-    	// map the target vector to an Eigen Vector
-    	Eigen::Map<const Eigen::VectorXf> y(y_values.data(), n_rows);
-
-    	// add bias term, solve theta for weights 
-    	Eigen::MatrixXf X_b(n_rows, n_cols + 1);
-    	X_b.setOnes();
-    	X_b.rightCols(n_cols) = X;
-    	m_theta = (X_b.transpose() * X_b).ldlt().solve(X_b.transpose() * y);
+    	m_theta = solveNormalEquations(X_view, y_values, 0.0f);
 }
 
 std::vector<float> LinRegModel::predict(const std::vector<float>& x_values, const std::vector<std::string>& columns) const {
@@ -103,17 +119,31 @@ std::vector<float> LinRegModel::predict(const std::vector<float>& x_values, cons
          	throw std::invalid_argument("Number of features in prediction data does not match the trained model.");
     	}
 
-    	// map the 1D float vector to an Eigen Matrix
-    	Eigen::Map<const Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>> X_test(x_values.data(), n_rows, n_cols);
+    	std::vector<float> predictions(n_rows);
+    	predictInto(MatrixView(x_values.data(), n_rows, n_cols), predictions);
+    	return predictions;
+}
 
-    	// add bias term and predict
-    	Eigen::MatrixXf X_test_b(X_test.rows(), X_test.cols() + 1);
-    	X_test_b.setOnes();
-    	X_test_b.rightCols(X_test.cols()) = X_test;
-    	Eigen::VectorXf predictions_eigen = X_test_b * m_theta;
+void LinRegModel::predictInto(const MatrixView& X, Span<float> out) const {
+	if (m_theta.size() == 0) {
+        	throw std::logic_error("Model has not been fitted yet. Call fit() before predict().");
+    	}
+
+    	if (static_cast<std::size_t>(m_theta.size()) != X.cols + 1) {
+         	throw std::invalid_argument("Number of features in prediction data does not match the trained model.");
+    	}
+
+    	if (out.size != X.rows) {
+         	throw std::invalid_argument("predictInto: output size must match the number of rows.");
+    	}
 
-    	// convert Eigen::VectorXf back to std::vector<float> after done with Eigen 
-    	return std::vector<float>(predictions_eigen.data(), predictions_eigen.data() + predictions_eigen.size());
+    	// each chunk maps its rows in place and writes bias + X * weights straight into out, no bias column copy
+    	const Eigen::Index n_cols = static_cast<Eigen::Index>(X.cols);
+    	ThreadPool::shared().parallelChunks(X.rows, getPredictThreads(), 4096, [&](std::size_t begin, std::size_t end) {
+        	Eigen::Map<Eigen::VectorXf> out_chunk(out.data + begin, static_cast<Eigen::Index>(end - begin));
+        	out_chunk.noalias() = asEigen(X.slice(begin, end)) * m_theta.tail(n_cols);
+        	out_chunk.array() += m_theta(0);
+    	});
 }
 
 std::string LinRegModel::getName() const {
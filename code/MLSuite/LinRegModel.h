@@ -11,7 +11,7 @@ class LinRegModel : public IModel { // implement IModel for it to work with clas
 public:
 	LinRegModel();
 
-    	void fit(Dataset& X_dataset, Dataset& y_dataset, const std::string& regularization = "None", double lambda = 0.1);
+    	void fit(const Dataset& X_dataset, const Dataset& y_dataset, const std::string& regularization = "None", double lambda = 0.1);
     	Eigen::VectorXf predict(const Eigen::Ref<const Eigen::MatrixXf>& X_test);
     	Eigen::VectorXf get_theta();
 
@@ -19,6 +19,9 @@ public:
     	void fit(const std::vector<float>& x_values, const std::vector<std::string>& columns, const std::vector<float>& y_values) override;
     	std::vector<float> predict(const std::vector<float>& x_values, const std::vector<std::string>& columns) const override;
     	std::string getName() const override;
+    	// rows split over getPredictThreads(), writes straight into out without allocating
+    	void predictInto(const MatrixView& X, Span<float> out) const override;
+    	void fitView(const MatrixView& X, Span<const float> y) override;
 
 private:
     	Eigen::VectorXf m_theta;
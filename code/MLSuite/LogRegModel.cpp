@@ -1,6 +1,35 @@
 #include "LogRegModel.h"
 #include <cmath> 
 #include <iostream> 
+#include "ThreadPool.h"
+
+namespace {
+	// MatrixView as an Eigen matrix, rows X.stride and columns X.colStride floats apart (row-major or mapped columns)
+	using StridedView = Eigen::Map<const Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>, 0, Eigen::Stride<Eigen::Dynamic, Eigen::Dynamic>>;
+
+	StridedView asEigen(const MatrixView& X) {
+		return StridedView(X.data, static_cast<Eigen::Index>(X.rows), static_cast<Eigen::Index>(X.cols),
+		                   Eigen::Stride<Eigen::Dynamic, Eigen::Dynamic>(static_cast<Eigen::Index>(X.stride), static_cast<Eigen::Index>(X.colStride)));
+	}
+
+	void checkSolverSettings(const std::string& regularization, double learning_rate, int num_iterations) {
+    		if (regularization != "None" && regularization != "L2" && regularization != "L1") {
+        		throw std::invalid_argument("Invalid regularization type. Must be 'None', 'L1', or 'L2'.");
+    		}
+
+    		if (regularization == "L1") {
+        		throw std::logic_error("L1 regularization for Logistic Regression requires an iterative solver with subgradient methods and is not supported by this implementation.");
+    		}
+
+    		if (learning_rate <= 0) {
+        		throw std::invalid_argument("Learning rate must be positive.");
+    		}
+
+    		if (num_iterations <= 0) {
+        		throw std::invalid_argument("Number of iterations must be positive.");
+    		}
+	}
+}
 
 LogRegModel::LogRegModel() {}
 
@@ -23,29 +52,28 @@ void LogRegModel::fit(const std::vector<float>& x_values, const std::vector<std:
         	throw std::invalid_argument("The size of x_values is not a multiple of the number of columns.");
     	}
 
-    	if (n_rows != y_values_vec.size()) {
-        	throw std::invalid_argument("Number of samples in features and targets do not match.");
-    	}
+    	fit(MatrixView(x_values.data(), n_rows, n_cols), y_values_vec, regularization, lambda, learning_rate, num_iterations);
+}
 
-    	if (regularization != "None" && regularization != "L2" && regularization != "L1") {
-        	throw std::invalid_argument("Invalid regularization type. Must be 'None', 'L1', or 'L2'.");
+// gradient descent on the log loss over a strided view
+void LogRegModel::fit(const MatrixView& X_view, Span<const float> y_values, const std::string& regularization, double lambda,
+		      double learning_rate, int num_iterations) {
+    	if (X_view.empty() || y_values.size == 0) {
+        	throw std::invalid_argument("Input vectors cannot be empty.");
     	}
 
-    	if (regularization == "L1") {
-        	throw std::logic_error("L1 regularization for Logistic Regression requires an iterative solver with subgradient methods and is not supported by this implementation.");
+    	if (X_view.rows != y_values.size) {
+        	throw std::invalid_argument("Number of samples in features and targets do not match.");
     	}
 
-    	if (learning_rate <= 0) {
-        	throw std::invalid_argument("Learning rate must be positive.");
-    	}
+    	const Eigen::Index n_rows = static_cast<Eigen::Index>(X_view.rows);
+    	const Eigen::Index n_cols = static_cast<Eigen::Index>(X_view.cols);
 
-    	if (num_iterations <= 0) {
-        	throw std::invalid_argument("Number of iterations must be positive.");
-    	}
+    	checkSolverSettings(regularization, learning_rate, num_iterations);
     
-    	// map the 1D float vector to an Eigen Matrix
-    	Eigen::Map<const Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>> X(x_values.data(), n_rows, n_cols);
-    	Eigen::Map<const Eigen::VectorXf> y(y_values_vec.data(), n_rows); // map the target vector to an Eigen Vector
+    	// map the strided view to an Eigen Matrix
+    	StridedView X = asEigen(X_view);
+    	Eigen::Map<const Eigen::VectorXf> y(y_values.data, n_rows); // map the target vector to an Eigen Vector
 
     	Eigen::MatrixXf X_b(n_rows, n_cols + 1);
     	X_b.setOnes();
@@ -73,6 +101,65 @@ void LogRegModel::fit(const std::vector<float>& x_values, const std::vector<std:
     }
 }
 
+// one gradient step per streamed batch, the gradient and the L2 term are averaged over the batch rows
+void LogRegModel::fit(DatasetStream& X_stream, DatasetStream& y_stream, const std::string& regularization, double lambda,
+		      double learning_rate, int num_epochs) {
+    	checkSolverSettings(regularization, learning_rate, num_epochs);
+
+    	if (X_stream.columns().empty()) {
+        	throw std::invalid_argument("Input vectors cannot be empty.");
+    	}
+
+    	if (y_stream.columns().size() != 1) {
+        	throw std::invalid_argument("Target stream must have exactly one column.");
+    	}
+
+    	const Eigen::Index n_cols = static_cast<Eigen::Index>(X_stream.columns().size());
+    	const bool l2 = regularization == "L2";
+    	m_theta = Eigen::VectorXf::Zero(n_cols + 1);
+    	Eigen::VectorXf error;
+    	Eigen::VectorXf gradient(n_cols + 1);
+
+    	for (int epoch = 0; epoch < num_epochs; ++epoch) {
+        	if (X_stream.rowsRead() > 0 || y_stream.rowsRead() > 0) {
+            		X_stream.reset();
+            		y_stream.reset();
+        	}
+
+        	MatrixView X_batch, y_batch;
+        	while (X_stream.next(X_batch)) {
+            		if (!y_stream.next(y_batch) || y_batch.rows != X_batch.rows) {
+                		throw std::invalid_argument("Number of samples in features and targets do not match.");
+            		}
+
+            		const StridedView X = asEigen(X_batch);
+            		const Eigen::Map<const Eigen::VectorXf> y(y_batch.data, static_cast<Eigen::Index>(y_batch.rows));
+            		const float n_rows = static_cast<float>(X_batch.rows);
+
+            		error.noalias() = X * m_theta.tail(n_cols);
+            		for (Eigen::Index i = 0; i < error.size(); ++i) {
+                		error(i) = sigmoid(error(i) + m_theta(0)) - y(i);
+            		}
+
+            		gradient(0) = error.sum() / n_rows;
+            		gradient.tail(n_cols).noalias() = X.transpose() * error / n_rows;
+            		if (l2) { // the bias term is not regularized
+                		gradient.tail(n_cols) += static_cast<float>(lambda / n_rows) * m_theta.tail(n_cols);
+            		}
+
+            		m_theta -= static_cast<float>(learning_rate) * gradient;
+        	}
+
+        	if (y_stream.next(y_batch)) {
+            		throw std::invalid_argument("Number of samples in features and targets do not match.");
+        	}
+
+        	if (X_stream.rowsRead() == 0) {
+            		throw std::invalid_argument("Input vectors cannot be empty.");
+        	}
+    	}
+}
+
 Eigen::VectorXf LogRegModel::predict_proba(const Eigen::Ref<const Eigen::MatrixXf>& X_test) const {
 
 	if (m_theta.size() == 0) {
@@ -111,6 +198,10 @@ void LogRegModel::fit(const std::vector<float>& x_values, const std::vector<std:
 	fit(x_values, columns, y_values, "None", 0.0, 0.01, 1000); 
 }
 
+void LogRegModel::fitView(const MatrixView& X, Span<const float> y) {
+	fit(X, y, "None", 0.0, 0.01, 1000);
+}
+
 std::vector<float> LogRegModel::predict(const std::vector<float>& x_values, const std::vector<std::string>& columns) const {
 	if (x_values.empty() || columns.empty()) {
         	return {};
@@ -131,14 +222,34 @@ std::vector<float> LogRegModel::predict(const std::vector<float>& x_values, cons
         	throw std::invalid_argument("Number of features in prediction data does not match the trained model.");
     	}
 
-    	// map 1D float vector to an Eigen Matrix
-    	Eigen::Map<const Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>> X_test_eigen(x_values.data(), n_rows, n_cols);
+    	std::vector<float> predictions(n_rows);
+    	predictInto(MatrixView(x_values.data(), n_rows, n_cols), predictions);
+    	return predictions;
+}
+
+void LogRegModel::predictInto(const MatrixView& X, Span<float> out) const {
+	if (m_theta.size() == 0) {
+        	throw std::logic_error("Model has not been fitted yet. Call fit() before predict().");
+    	}
+
+    	if (static_cast<std::size_t>(m_theta.size()) != X.cols + 1) { // +1 for bias term 
+        	throw std::invalid_argument("Number of features in prediction data does not match the trained model.");
+    	}
 
-    	// get preds 
-    	Eigen::VectorXf predictions_eigen = predict(X_test_eigen);
+    	if (out.size != X.rows) {
+        	throw std::invalid_argument("predictInto: output size must match the number of rows.");
+    	}
 
-    	// Eigen::VectorXf back to std::vector<float>
-    	return std::vector<float>(predictions_eigen.data(), predictions_eigen.data() + predictions_eigen.size());
+    	// same 0.5 probability threshold as predict(), applied per chunk without the bias column copy
+    	const Eigen::Index n_cols = static_cast<Eigen::Index>(X.cols);
+    	ThreadPool::shared().parallelChunks(X.rows, getPredictThreads(), 4096, [&](std::size_t begin, std::size_t end) {
+        	const Eigen::Index rows = static_cast<Eigen::Index>(end - begin);
+        	Eigen::Map<Eigen::VectorXf> out_chunk(out.data + begin, rows);
+        	out_chunk.noalias() = asEigen(X.slice(begin, end)) * m_theta.tail(n_cols);
+        	for (Eigen::Index i = 0; i < rows; ++i) {
+            		out_chunk(i) = (sigmoid(out_chunk(i) + m_theta(0)) >= 0.5f) ? 1.0f : 0.0f;
+        	}
+    	});
 }
 
 // get name for benchmarkstrategy 
@@ -4,6 +4,7 @@
 
 #include "IModel.h"
 #include "Dataset.h"
+#include "DatasetStream.h"
 #include <Eigen/Dense>
 #include <vector>
 #include <string>
@@ -15,6 +16,13 @@ public:
 
     	void fit(const std::vector<float>& x_values, const std::vector<std::string>& columns, const std::vector<float>& y_values_vec, 
 	      const std::string& regularization = "None", double lambda = 0.0, double learning_rate = 0.01, int num_iterations = 1000);
+    	void fit(const MatrixView& X, Span<const float> y, const std::string& regularization = "None", double lambda = 0.0,
+	      double learning_rate = 0.01, int num_iterations = 1000);
+
+    	// mini-batch gradient descent over streamed features and a single-column target stream: one step per batch,
+    	// num_epochs passes over the data (both streams are rewound between passes)
+    	void fit(DatasetStream& X, DatasetStream& y, const std::string& regularization = "None", double lambda = 0.0,
+	      double learning_rate = 0.01, int num_epochs = 10);
 
     	Eigen::VectorXf predict_proba(const Eigen::Ref<const Eigen::MatrixXf>& X_test) const;
 
@@ -25,6 +33,9 @@ public:
     	void fit(const std::vector<float>& x_values, const std::vector<std::string>& columns, const std::vector<float>& y_values) override;
     	std::vector<float> predict(const std::vector<float>& x_values, const std::vector<std::string>& columns) const override;
     	std::string getName() const override;
+    	// rows split over getPredictThreads(), writes straight into out without allocating
+    	void predictInto(const MatrixView& X, Span<float> out) const override;
+    	void fitView(const MatrixView& X, Span<const float> y) override;
 
 private:
     	Eigen::VectorXf m_theta;
@@ -46,11 +46,8 @@ LogRegModel LogisticRegressionBuilder::fit() {
 
     	LogRegModel model;
 
-    	std::vector<float> x_data = m_X_train->get_data();
-    	std::vector<std::string> x_cols = m_X_train->get_columns();
-    	std::vector<float> y_data = m_y_train->get_data();
-
-    	model.fit(x_data, x_cols, y_data, m_regularization, m_lambda, m_learning_rate, m_num_iterations);
+    	// views over the training datasets, nothing is copied
+    	model.fit(m_X_train->view(), m_y_train->values(), m_regularization, m_lambda, m_learning_rate, m_num_iterations);
     	return model;
 }
 
@@ -0,0 +1,26 @@
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <cstddef>
+#include <string>
+
+// MappedFile maps a whole file read-only into memory (mmap, MapViewOfFile on Windows). Pages are loaded on first
+// access and shared with every other process mapping the same file. Throws std::runtime_error if the file cannot
+// be opened or mapped; empty files are not mappable.
+class MappedFile {
+public:
+	explicit MappedFile(const std::string& path);
+	~MappedFile();
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	const unsigned char* data() const { return bytes; }
+	std::size_t size() const { return length; }
+
+private:
+	const unsigned char* bytes = nullptr;
+	std::size_t length = 0;
+};
+
+#endif
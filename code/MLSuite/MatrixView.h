@@ -0,0 +1,75 @@
+#ifndef MATRIXVIEW_H
+#define MATRIXVIEW_H
+
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+// MatrixView is a non-owning float matrix: element (i, j) is data[i * stride + j * colStride], so a sub-block of a
+// larger buffer, a Dataset's row-major data or the columns of a mapped binary file can be passed to a model without
+// copying it. Views are row-major (colStride 1, stride >= cols) unless made by columnMajor().
+struct MatrixView {
+	const float* data = nullptr;
+	std::size_t rows = 0;
+	std::size_t cols = 0;
+	std::size_t stride = 0;
+	std::size_t colStride = 1;
+
+	MatrixView() = default;
+	MatrixView(const float* values, std::size_t nRows, std::size_t nCols, std::size_t rowStride = 0)
+		: data(values), rows(nRows), cols(nCols), stride(rowStride == 0 ? nCols : rowStride) {}
+
+	// column j starts at values + j * columnStride (columnStride >= nRows), rows are contiguous within a column
+	static MatrixView columnMajor(const float* values, std::size_t nRows, std::size_t nCols, std::size_t columnStride = 0) {
+		MatrixView view(values, nRows, nCols, 1);
+		view.colStride = columnStride == 0 ? nRows : columnStride;
+		return view;
+	}
+
+	bool empty() const { return rows == 0 || cols == 0; }
+	bool isRowMajor() const { return colStride == 1; }
+	// start of row i, its cols values are contiguous only when isRowMajor()
+	const float* row(std::size_t i) const { return data + i * stride; }
+	float operator()(std::size_t i, std::size_t j) const { return data[i * stride + j * colStride]; }
+
+	// rows [begin, end) of this view
+	MatrixView slice(std::size_t begin, std::size_t end) const {
+		MatrixView view = *this;
+		view.data = row(begin);
+		view.rows = end - begin;
+		return view;
+	}
+
+	// contiguous row-major copy, rows * cols values
+	std::vector<float> toVector() const {
+		std::vector<float> out;
+		out.reserve(rows * cols);
+		for (std::size_t i = 0; i < rows; ++i) {
+			if (isRowMajor()) {
+				out.insert(out.end(), row(i), row(i) + cols);
+			} else {
+				for (std::size_t j = 0; j < cols; ++j) out.push_back((*this)(i, j));
+			}
+		}
+		return out;
+	}
+};
+
+// Span is a non-owning contiguous range, e.g. the caller's output buffer for IModel::predictInto
+template <class T>
+struct Span {
+	T* data = nullptr;
+	std::size_t size = 0;
+
+	Span() = default;
+	Span(T* values, std::size_t count) : data(values), size(count) {}
+	Span(std::vector<std::remove_const_t<T>>& v) : data(v.data()), size(v.size()) {}
+	template <class U = T, class = std::enable_if_t<std::is_const<U>::value>>
+	Span(const std::vector<std::remove_const_t<T>>& v) : data(v.data()), size(v.size()) {}
+
+	T& operator[](std::size_t i) const { return data[i]; }
+	T* begin() const { return data; }
+	T* end() const { return data + size; }
+};
+
+#endif
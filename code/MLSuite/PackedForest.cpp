@@ -0,0 +1,170 @@
+#include "PackedForest.h"
+#include "DecisionTree.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define PACKEDFOREST_AVX2 1
+#endif
+
+namespace {
+	constexpr int kLanes = 16;      // rows pushed through a tree together
+	constexpr int kBlockRows = 64;  // rows per tile, each tree is walked for the whole tile before the next one
+
+	// leaf index reached by each of the kLanes tile rows
+	void traverseScalar(const PackedNode* nodes, std::uint32_t root, const float* tile, int nCols, std::uint32_t* leaf) {
+		for (int lane = 0; lane < kLanes; ++lane) {
+			const float* row = tile + static_cast<std::size_t>(lane) * nCols;
+			std::uint32_t idx = root;
+			while (!nodes[idx].isLeaf()) {
+				idx = nodes[idx].left + (row[nodes[idx].feature()] <= nodes[idx].threshold ? 0u : 1u);
+			}
+			leaf[lane] = idx;
+		}
+	}
+
+#ifdef PACKEDFOREST_AVX2
+	// one level step for 8 lanes; leaf lanes keep their index
+	__attribute__((target("avx2")))
+	inline __m256i stepAvx2(const int* words, const float* tile, __m256i laneOffset, __m256i idx) {
+		const __m256i word = _mm256_slli_epi32(idx, 2);
+		const __m256i featureAndFlag = _mm256_i32gather_epi32(words, word, 4);
+		const __m256i left = _mm256_i32gather_epi32(words + 1, word, 4);
+		const __m256 thr = _mm256_i32gather_ps(reinterpret_cast<const float*>(words + 2), word, 4);
+		const __m256i feature = _mm256_and_si256(featureAndFlag, _mm256_set1_epi32(static_cast<int>(~PackedNode::kLeafBit)));
+		const __m256 x = _mm256_i32gather_ps(tile, _mm256_add_epi32(laneOffset, feature), 4);
+
+		// !(x <= thr) goes right, the same rule as the scalar walk (NaN goes right); the mask is -1 per lane
+		const __m256i goRight = _mm256_castps_si256(_mm256_cmp_ps(x, thr, _CMP_NLE_UQ));
+		const __m256i next = _mm256_sub_epi32(left, goRight);
+		const __m256i isLeaf = _mm256_srai_epi32(featureAndFlag, 31);
+		return _mm256_blendv_epi8(next, idx, isLeaf);
+	}
+
+	// two independent groups of 8 lanes per step so the gathers of one hide the latency of the other
+	__attribute__((target("avx2")))
+	void traverseAvx2(const PackedNode* nodes, std::uint32_t root, const float* tile, int nCols, std::uint32_t* leaf) {
+		// a node is 4 ints: featureAndFlag, left, threshold (low half of the value union)
+		const int* words = reinterpret_cast<const int*>(nodes);
+		const __m256i laneOffset = _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32(nCols));
+		const float* tileHi = tile + static_cast<std::size_t>(8) * nCols;
+		__m256i lo = _mm256_set1_epi32(static_cast<int>(root));
+		__m256i hi = lo;
+
+		while (true) {
+			const __m256i flagsLo = _mm256_i32gather_epi32(words, _mm256_slli_epi32(lo, 2), 4);
+			const __m256i flagsHi = _mm256_i32gather_epi32(words, _mm256_slli_epi32(hi, 2), 4);
+			// leaf bit is the sign bit
+			if (_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_and_si256(flagsLo, flagsHi))) == 0xFF) break;
+			lo = stepAvx2(words, tile, laneOffset, lo);
+			hi = stepAvx2(words, tileHi, laneOffset, hi);
+		}
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(leaf), lo);
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(leaf + 8), hi);
+	}
+#endif
+
+	using TraverseFn = void (*)(const PackedNode*, std::uint32_t, const float*, int, std::uint32_t*);
+
+	TraverseFn selectTraverse() {
+#ifdef PACKEDFOREST_AVX2
+		if (__builtin_cpu_supports("avx2")) return traverseAvx2;
+#endif
+		return traverseScalar;
+	}
+}
+
+bool PackedForest::simdAvailable() {
+	return selectTraverse() != traverseScalar;
+}
+
+// the largest float not above threshold, so for every float x: x <= result exactly when x <= threshold
+PackedNode PackedNode::split(int feature, double threshold, std::uint32_t left) {
+	float t = static_cast<float>(threshold);
+	if (static_cast<double>(t) > threshold) {
+		t = std::nextafter(t, -std::numeric_limits<float>::infinity());
+	}
+
+	PackedNode node;
+	node.featureAndFlag = static_cast<std::uint32_t>(feature);
+	node.left = left;
+	node.value = 0.0;
+	node.threshold = t;
+	return node;
+}
+
+PackedNode PackedNode::leaf(double value) {
+	PackedNode node;
+	node.featureAndFlag = kLeafBit;
+	node.left = 0;
+	node.value = value;
+	return node;
+}
+
+void PackedForest::clear() {
+	nodes.clear();
+	roots.clear();
+}
+
+template <class Scalar>
+void PackedForest::addTree(const BasicDecisionTree<Scalar>& tree, double scale) {
+	roots.push_back(static_cast<std::uint32_t>(nodes.size()));
+	tree.packInto(nodes, scale);
+}
+
+template void PackedForest::addTree(const BasicDecisionTree<float>&, double);
+template void PackedForest::addTree(const BasicDecisionTree<double>&, double);
+
+// walks rows rowAt(0) .. rowAt(count - 1) of X through every tree and calls visit(k, tree, leafValue), trees in order
+// for each row
+template <class RowAt, class Visit>
+static void forEachLeaf(const std::vector<PackedNode>& nodes, const std::vector<std::uint32_t>& roots,
+                        const FeatureMatrix& X, std::size_t count, RowAt rowAt, Visit visit) {
+	static const TraverseFn traverse = selectTraverse();
+	const int nCols = static_cast<int>(X.cols());
+	thread_local std::vector<float> tile; // reused across calls, so warm batches do not allocate
+	tile.resize(static_cast<std::size_t>(kBlockRows) * nCols);
+	std::uint32_t leaf[kLanes];
+
+	for (std::size_t blockBegin = 0; blockBegin < count; blockBegin += kBlockRows) {
+		const int blockRows = static_cast<int>(std::min<std::size_t>(kBlockRows, count - blockBegin));
+		const int paddedRows = (blockRows + kLanes - 1) / kLanes * kLanes;
+		for (int r = 0; r < paddedRows; ++r) {
+			// the last group is padded with copies of the block's first row, their results are dropped
+			X.copyRow(rowAt(blockBegin + (r < blockRows ? r : 0)), tile.data() + static_cast<std::size_t>(r) * nCols);
+		}
+
+		for (std::size_t t = 0; t < roots.size(); ++t) {
+			for (int g = 0; g < paddedRows; g += kLanes) {
+				traverse(nodes.data(), roots[t], tile.data() + static_cast<std::size_t>(g) * nCols, nCols, leaf);
+				const int lanes = std::min(kLanes, blockRows - g);
+				for (int lane = 0; lane < lanes; ++lane) {
+					visit(blockBegin + g + lane, static_cast<int>(t), nodes[leaf[lane]].value);
+				}
+			}
+		}
+	}
+}
+
+void PackedForest::leafValues(const FeatureMatrix& X, std::size_t begin, std::size_t end, double* out) const {
+	const std::size_t nTrees = roots.size();
+	forEachLeaf(nodes, roots, X, end - begin, [begin](std::size_t k) { return begin + k; }, [out, nTrees](std::size_t r, int t, double v) {
+		out[r * nTrees + t] = v;
+	});
+}
+
+void PackedForest::sums(const FeatureMatrix& X, std::size_t begin, std::size_t end, double* out) const {
+	std::fill(out, out + (end - begin), 0.0);
+	forEachLeaf(nodes, roots, X, end - begin, [begin](std::size_t k) { return begin + k; }, [out](std::size_t r, int, double v) {
+		out[r] += v;
+	});
+}
+
+void PackedForest::sumsAt(const FeatureMatrix& X, const int* rows, std::size_t count, double* out) const {
+	std::fill(out, out + count, 0.0);
+	forEachLeaf(nodes, roots, X, count, [rows](std::size_t k) { return static_cast<std::size_t>(rows[k]); }, [out](std::size_t r, int, double v) {
+		out[r] += v;
+	});
+}
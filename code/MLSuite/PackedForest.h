@@ -0,0 +1,79 @@
+#ifndef PACKEDFOREST_H
+#define PACKEDFOREST_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "FeatureMatrix.h"
+
+template <class Scalar> class BasicDecisionTree;
+
+// one node of an inference-only tree: 16 bytes, children of a split are stored next to each other so only the
+// left child index is kept, and the leaf flag lives in the top bit of the feature index
+struct PackedNode {
+	static constexpr std::uint32_t kLeafBit = 0x80000000u;
+
+	std::uint32_t featureAndFlag; // split feature, or kLeafBit for leaves
+	std::uint32_t left;           // index of the left child in the packed array, right child is left + 1
+	union {
+		float threshold;          // split: go left when x <= threshold
+		double value;             // leaf: prediction
+	};
+
+	bool isLeaf() const { return (featureAndFlag & kLeafBit) != 0; }
+	std::uint32_t feature() const { return featureAndFlag & ~kLeafBit; }
+
+	static PackedNode split(int feature, double threshold, std::uint32_t left);
+	static PackedNode leaf(double value);
+};
+
+static_assert(sizeof(PackedNode) == 16, "PackedNode must stay 16 bytes");
+
+// PackedForest is the read-only form RandomForest and XGBoostModel compile their trees to after fit:
+// all trees in one contiguous array, each laid out breadth first so the top levels shared by every row stay in cache.
+// The batch methods copy blocks of rows into a small row-major tile and push 16 rows through a tree together, one
+// level per step (leaves keep their index), with AVX2 gathers when the CPU has them and a scalar loop otherwise.
+class PackedForest {
+public:
+	void clear();
+	// appends a fitted tree of either precision, its leaf values multiplied by scale (the learning rate for boosted trees)
+	template <class Scalar>
+	void addTree(const BasicDecisionTree<Scalar>& tree, double scale = 1.0);
+
+	int getNTrees() const { return static_cast<int>(roots.size()); }
+	std::size_t getNNodes() const { return nodes.size(); }
+	const std::vector<PackedNode>& getNodes() const { return nodes; }
+	std::uint32_t root(int tree) const { return roots[tree]; }
+
+	// leaf value of one tree for a contiguous row of features
+	double leafValue(int tree, const float* row) const {
+		const PackedNode* n = &nodes[roots[tree]];
+		while (!n->isLeaf()) {
+			n = &nodes[n->left + (row[n->feature()] <= n->threshold ? 0u : 1u)];
+		}
+		return n->value;
+	}
+
+	// sum of every tree's leaf value, in tree order
+	double sum(const float* row) const {
+		double total = 0.0;
+		for (int t = 0; t < getNTrees(); ++t) total += leafValue(t, row);
+		return total;
+	}
+
+	// every tree's leaf value for rows [begin, end) of X, out[(row - begin) * getNTrees() + tree]
+	void leafValues(const FeatureMatrix& X, std::size_t begin, std::size_t end, double* out) const;
+	// sum(row) for rows [begin, end) of X, out[row - begin]
+	void sums(const FeatureMatrix& X, std::size_t begin, std::size_t end, double* out) const;
+	// sum(row) for the count rows of X listed in rows, out[k] for rows[k]
+	void sumsAt(const FeatureMatrix& X, const int* rows, std::size_t count, double* out) const;
+
+	// true when the batch methods use the AVX2 kernel on this machine
+	static bool simdAvailable();
+
+private:
+	std::vector<PackedNode> nodes;
+	std::vector<std::uint32_t> roots; // index of every tree's root in nodes
+};
+
+#endif
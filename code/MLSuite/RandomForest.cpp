@@ -6,7 +6,8 @@
 #include <tuple>
 #include <utility>
 #include <limits>
-#include <map>
+#include <cstdint>
+#include <type_traits>
 
 namespace {
 	double meanOf(const std::vector<double>& v) {
@@ -18,9 +19,36 @@ namespace {
 	int clampInt(int x, int lo, int hi) {
     		return std::max(lo, std::min(x, hi));
 	}
+
+	// Classification: Majority Vote Logic over the rounded per-tree labels, ties go to the smallest label.
+	// Labels are sorted in a per-thread buffer and counted as runs, so voting does not allocate once warm.
+	double majorityVote(const double* perTree, int nTrees) {
+		thread_local std::vector<int> labels;
+		labels.resize(static_cast<std::size_t>(nTrees));
+		for (int t = 0; t < nTrees; ++t) {
+			labels[t] = static_cast<int>(std::round(perTree[t]));
+		}
+		std::sort(labels.begin(), labels.end());
+
+		int bestLabel = -1;
+		int maxCount = -1;
+
+		for (std::size_t i = 0; i < labels.size();) {
+			std::size_t j = i;
+			while (j < labels.size() && labels[j] == labels[i]) ++j;
+			const int count = static_cast<int>(j - i);
+			if (count > maxCount) {
+				maxCount = count;
+				bestLabel = labels[i];
+			}
+			i = j;
+		}
+		return static_cast<double>(bestLabel);
+	}
 } 
 
-RandomForest::RandomForest(int Estimators, int maxDepth, int minSamplesSplit, int maxFeatures, bool bootstrap, int randomState, bool isClassification)
+template <class Scalar>
+BasicRandomForest<Scalar>::BasicRandomForest(int Estimators, int maxDepth, int minSamplesSplit, int maxFeatures, bool bootstrap, int randomState, bool isClassification)
     : nEstimators(Estimators),
     maxDepth(maxDepth),
     minSamplesSplit(minSamplesSplit),
@@ -29,8 +57,7 @@ RandomForest::RandomForest(int Estimators, int maxDepth, int minSamplesSplit, in
     randomState(randomState),
     isClassification(isClassification),
     isFitted(false),
-    nFeatures(0),
-    internalRng(static_cast<std::mt19937::result_type>(randomState)) // seed RNG
+    nFeatures(0)
 {
 	if (nEstimators <= 0) {
         	throw std::invalid_argument("RandomForest: nEstimators must be > 0");
@@ -41,100 +68,185 @@ RandomForest::RandomForest(int Estimators, int maxDepth, int minSamplesSplit, in
     	}
 }
 
-void RandomForest::fit(const std::vector<std::vector<double>>& X, const std::vector<double>& Y) {
+template <class Scalar>
+void BasicRandomForest<Scalar>::setMaxBins(int bins) {
+	if (bins < 2 || bins > FeatureBins::kMaxBins) {
+		throw std::invalid_argument("RandomForest: maxBins must be in [2, 256]");
+	}
+	maxBins = bins;
+}
+
+template <class Scalar>
+void BasicRandomForest<Scalar>::setMaxFeaturesFraction(double fraction) {
+	if (!(fraction > 0.0 && fraction <= 1.0)) {
+		throw std::invalid_argument("RandomForest: maxFeatures fraction must be in (0, 1]");
+	}
+	maxFeaturesFraction = fraction;
+	maxFeaturesPolicy = MaxFeaturesPolicy::Fraction;
+}
+
+template <class Scalar>
+int BasicRandomForest<Scalar>::featuresPerSplit(int p) const {
+	int k = p;
+	switch (maxFeaturesPolicy) {
+		case MaxFeaturesPolicy::Count:
+			// 0 => floor(sqrt(p))
+			k = (maxFeatures == 0) ? static_cast<int>(std::floor(std::sqrt(static_cast<double>(p)))) : maxFeatures;
+			break;
+		case MaxFeaturesPolicy::Sqrt:
+			k = static_cast<int>(std::floor(std::sqrt(static_cast<double>(p))));
+			break;
+		case MaxFeaturesPolicy::Log2:
+			k = static_cast<int>(std::floor(std::log2(static_cast<double>(p))));
+			break;
+		case MaxFeaturesPolicy::Fraction:
+			k = static_cast<int>(std::ceil(maxFeaturesFraction * p));
+			break;
+		case MaxFeaturesPolicy::All:
+			k = p;
+			break;
+	}
+	return clampInt(k, 1, p);
+}
+
+template <class Scalar>
+void BasicRandomForest<Scalar>::fit(const std::vector<std::vector<double>>& X, const std::vector<double>& Y) {
 	if (X.empty()) {
         	throw std::invalid_argument("fit: X is empty");
     	}
 
-    	if (X.size() != Y.size()) {
+    	// check consistent dims
+    	for (const auto& row : X) {
+        	if (row.size() != X[0].size()) {
+            		throw std::invalid_argument("fit: inconsistent feature dimensions in X");
+        	}
+    	}
+
+    	fit(FeatureMatrix(X), Y);
+}
+
+template <class Scalar>
+void BasicRandomForest<Scalar>::fit(const FeatureMatrix& X, const std::vector<double>& Y) {
+	if constexpr (std::is_same<Scalar, double>::value) {
+		fit(X, Span<const double>(Y));
+	} else {
+		const std::vector<Scalar> targets(Y.begin(), Y.end());
+		fit(X, Span<const Scalar>(targets));
+	}
+}
+
+template <class Scalar>
+void BasicRandomForest<Scalar>::fit(const FeatureMatrix& X, Span<const Scalar> Y) {
+	if (X.rows() == 0) {
+        	throw std::invalid_argument("fit: X is empty");
+    	}
+
+    	if (X.rows() != Y.size) {
         	throw std::invalid_argument("fit: X and Y size mismatch");
     	}
 
-    	nFeatures = static_cast<int>(X[0].size());
+    	nFeatures = static_cast<int>(X.cols());
 
     	if (nFeatures <= 0) {
         	throw std::invalid_argument("fit: X must have at least one feature");
     	}
-	
-    	// check consistent dims
-    	for (const auto& row : X) {
-        	if (static_cast<int>(row.size()) != nFeatures) {
-            		throw std::invalid_argument("fit: inconsistent feature dimensions in X");
-        	}
-    	}
 
-    	// Resolve maxFeatures default (0 => floor(sqrt(p)))
-    	if (maxFeatures == 0) {
-        	maxFeatures = static_cast<int>(std::floor(std::sqrt(static_cast<double>(nFeatures))));
-        	maxFeatures = std::max(1, std::min(maxFeatures, nFeatures));
-    	} else {
-        	maxFeatures = clampInt(maxFeatures, 1, nFeatures);
+    	// all trees read the same X (and the same quantized copy in Histogram mode)
+    	std::shared_ptr<const FeatureBins> bins;
+    	if (splitMode == SplitMode::Histogram) {
+        	bins = std::make_shared<const FeatureBins>(X, maxBins);
     	}
 
-    	trees.clear();
-    	trees.reserve(static_cast<std::size_t>(nEstimators));
+    	// every tree owns its slot and its random stream, so the forest is the same for any thread count
+    	std::vector<BasicDecisionTree<Scalar>> built(static_cast<std::size_t>(nEstimators), BasicDecisionTree<Scalar>(maxDepth, minSamplesSplit, isClassification));
+    	// the shared pool, capped at numThreads ranges of trees; each tree grows on one worker (its split search stays
+    	// serial), so the forest is parallel across trees only
+    	const int threads = std::min(ThreadPool::resolveThreadCount(numThreads), nEstimators);
+    	ThreadPool::shared().parallelChunks(built.size(), threads, 1, [&](std::size_t begin, std::size_t end) {
+        	for (std::size_t t = begin; t < end; ++t) built[t] = buildTree(X, Y, bins, static_cast<int>(t));
+    	});
+
+    	trees = std::move(built);
 
-    	for (int t = 0; t < nEstimators; ++t) {
-        	buildTree(X, Y);
+    	packed.clear();
+    	for (const auto& tree : trees) {
+        	packed.addTree(tree);
     	}
 
     	isFitted = true;
 }
 
-void RandomForest::buildTree(const std::vector<std::vector<double>>& X, const std::vector<double>& Y) {
-	const int n = static_cast<int>(X.size());
+// independent stream per tree derived from (randomState, treeIndex)
+template <class Scalar>
+std::mt19937 BasicRandomForest<Scalar>::treeRng(int treeIndex) const {
+	std::seed_seq seed{static_cast<std::uint32_t>(randomState), static_cast<std::uint32_t>(treeIndex)};
+	return std::mt19937(seed);
+}
+
+template <class Scalar>
+BasicDecisionTree<Scalar> BasicRandomForest<Scalar>::buildTree(const FeatureMatrix& X, Span<const Scalar> Y,
+                                     const std::shared_ptr<const FeatureBins>& bins, int treeIndex) const {
+	const int n = static_cast<int>(X.rows());
+	std::mt19937 rng = treeRng(treeIndex);
+
+    	BasicDecisionTree<Scalar> tree(maxDepth, minSamplesSplit, isClassification);
+    	tree.setSplitMode(splitMode);
+    	tree.setMaxBins(maxBins);
+    	tree.setFeatureBins(bins);
 
-    	// Choose sample indices (bootstrap or full)
-    	std::vector<int> indices;
+    	// the bootstrap is a draw count per row of the shared X, no rows are copied
+    	std::vector<int> counts;
     	if (bootstrap) {
-        	indices = sampleBootstrap(n); // size n with replacement
-    	} else {
-        	indices.resize(n);
-        	std::iota(indices.begin(), indices.end(), 0); // 0..n-1
+        	counts = sampleBootstrap(n, rng);
     	}
 
-    	// materialize the sample
-    	std::vector<std::vector<double>> Xb;
-    	std::vector<double> Yb;
-    	Xb.reserve(indices.size());
-    	Yb.reserve(indices.size());
-    	for (int idx : indices) {
-        	Xb.push_back(X[static_cast<std::size_t>(idx)]);
-        	Yb.push_back(Y[static_cast<std::size_t>(idx)]);
+    	// each node searches a fresh random subset of the features, drawn from this tree's stream
+    	const int k = featuresPerSplit(nFeatures);
+    	if (k < nFeatures) {
+        	tree.setFeatureSampler([k, rng, order = std::vector<int>()](int p, std::vector<int>& features) mutable {
+            		sampleFeatures(p, k, rng, order, features);
+        	});
     	}
 
-    	DecisionTree tree(maxDepth, minSamplesSplit, isClassification);
-    	tree.fit(Xb, Yb);                    
+    	tree.fit(X, Y, counts);
 
-	trees.push_back(std::move(tree));
+	return tree;
 }
 
-std::vector<int> RandomForest::sampleBootstrap(int n) {
+// n draws with replacement, returned as the number of times each row was drawn
+template <class Scalar>
+std::vector<int> BasicRandomForest<Scalar>::sampleBootstrap(int n, std::mt19937& rng) {
 	if (n <= 0) return {};
 	std::uniform_int_distribution<int> dist(0, n - 1);
-    	std::vector<int> idx;
-    	idx.reserve(static_cast<std::size_t>(n));
+    	std::vector<int> counts(static_cast<std::size_t>(n), 0);
 
     	for (int i = 0; i < n; ++i) {
-        	idx.push_back(dist(internalRng));
+        	++counts[dist(rng)];
     	}
 
-    	return idx;
+    	return counts;
 }
 
-std::vector<int> RandomForest::sampleFeatures(int p, int k) {
-	if (p <= 0 || k <= 0) return {};
-    	k = clampInt(k, 1, p);
+// k distinct features out of p (partial Fisher-Yates over a permutation reused across nodes), returned sorted
+template <class Scalar>
+void BasicRandomForest<Scalar>::sampleFeatures(int p, int k, std::mt19937& rng, std::vector<int>& order, std::vector<int>& features) {
+	k = clampInt(k, 1, p);
+    	if (static_cast<int>(order.size()) != p) {
+        	order.resize(static_cast<std::size_t>(p));
+        	std::iota(order.begin(), order.end(), 0);
+    	}
 
-    	std::vector<int> feats(p);
-    	std::iota(feats.begin(), feats.end(), 0);
-    	std::shuffle(feats.begin(), feats.end(), internalRng);
-    	feats.resize(static_cast<std::size_t>(k));
+    	for (int i = 0; i < k; ++i) {
+        	std::uniform_int_distribution<int> pick(i, p - 1);
+        	std::swap(order[i], order[pick(rng)]);
+    	}
 
-    	return feats;
+    	features.assign(order.begin(), order.begin() + k);
+    	std::sort(features.begin(), features.end()); // ties between equal gains go to the lower feature id
 }
 
-std::vector<std::vector<double>> RandomForest::predictAllTrees(const std::vector<std::vector<double>>& X) {
+template <class Scalar>
+std::vector<std::vector<double>> BasicRandomForest<Scalar>::predictAllTrees(const std::vector<std::vector<double>>& X) {
 	if (!isFitted) {
         	throw std::logic_error("predictAllTrees: model is not fitted");
     	}
@@ -152,11 +264,13 @@ std::vector<std::vector<double>> RandomForest::predictAllTrees(const std::vector
     	return out;
 }
 
-std::vector<double> RandomForest::aggregateMean(const std::vector<double>& preds) {
+template <class Scalar>
+std::vector<double> BasicRandomForest<Scalar>::aggregateMean(const std::vector<double>& preds) {
     return { meanOf(preds) }; // return the mean of predictions 
 }
 
-double RandomForest::predict(const std::vector<double>& x) const {
+template <class Scalar>
+double BasicRandomForest<Scalar>::predict(const std::vector<double>& x) const {
 	if (!isFitted) {
         	throw std::logic_error("predict: model is not fitted");
     	}
@@ -165,43 +279,74 @@ double RandomForest::predict(const std::vector<double>& x) const {
         	throw std::invalid_argument("predict: input dimension does not match training data");
     	}
 
+    	// the trees were trained on float32 features, so score the row the same way
+    	return predict(FeatureMatrix::fromColumnMajor(std::vector<float>(x.begin(), x.end()), 1, x.size()), 0);
+}
+
+template <class Scalar>
+double BasicRandomForest<Scalar>::predict(const FeatureMatrix& X, std::size_t row) const {
+	if (!isFitted) {
+        	throw std::logic_error("predict: model is not fitted");
+    	}
+
+    	if (static_cast<int>(X.cols()) != nFeatures) {
+        	throw std::invalid_argument("predict: input dimension does not match training data");
+    	}
+
+    	// one contiguous copy of the row, then every tree walks the packed nodes
+    	std::vector<float> x(static_cast<std::size_t>(nFeatures));
+    	X.copyRow(row, x.data());
+
         if (!isClassification) {
             	// Regression: Mean
-            	std::vector<double> perTree;
-            	perTree.reserve(trees.size());
-            	for (auto& tree : trees) {
-                	perTree.push_back(tree.predict(x));
-            	}
+            	return packed.sum(x.data()) / static_cast<double>(packed.getNTrees());
+        }
 
-            	return meanOf(perTree);
-        } else {
-            	// Classification: Majority Vote Logic
-            	std::map<int, int> counts;
-            	for (auto& tree : trees) {
-                	double p = tree.predict(x);
-                	int label = static_cast<int>(std::round(p));
-                	counts[label]++;
-            	}
+        std::vector<double> perTree(static_cast<std::size_t>(packed.getNTrees()));
+        for (int t = 0; t < packed.getNTrees(); ++t) {
+            	perTree[t] = packed.leafValue(t, x.data());
+        }
+        return majorityVote(perTree.data(), packed.getNTrees());
+}
 
-            	int bestLabel = -1;
-            	int maxCount = -1;
+template <class Scalar>
+void BasicRandomForest<Scalar>::predict(const FeatureMatrix& X, std::size_t begin, std::size_t end, double* out) const {
+	if (!isFitted) {
+        	throw std::logic_error("predict: model is not fitted");
+    	}
 
-            	for (auto const& [label, count] : counts) {
-                	if (count > maxCount) {
-                    		maxCount = count;
-                    		bestLabel = label;
-                	}
-            	}
-            return static_cast<double>(bestLabel);
-        }
+    	if (static_cast<int>(X.cols()) != nFeatures) {
+        	throw std::invalid_argument("predict: input dimension does not match training data");
+    	}
+
+    	const int nTrees = packed.getNTrees();
+    	if (!isClassification) {
+        	packed.sums(X, begin, end, out);
+        	for (std::size_t i = 0; i < end - begin; ++i) out[i] /= static_cast<double>(nTrees);
+        	return;
+    	}
+
+    	// votes need every tree's value, collected a chunk of rows at a time into a per-thread buffer
+    	constexpr std::size_t kChunkRows = 256;
+    	thread_local std::vector<double> perTree;
+    	perTree.resize(kChunkRows * static_cast<std::size_t>(nTrees));
+    	for (std::size_t chunk = begin; chunk < end; chunk += kChunkRows) {
+        	const std::size_t chunkEnd = std::min(end, chunk + kChunkRows);
+        	packed.leafValues(X, chunk, chunkEnd, perTree.data());
+        	for (std::size_t r = chunk; r < chunkEnd; ++r) {
+            		out[r - begin] = majorityVote(perTree.data() + (r - chunk) * nTrees, nTrees);
+        	}
+    	}
 }
 
 // model benchmarking interface concrete implementations for the strategy pattern.
-std::string RandomForest::getName() const {
-	return "Random Forest";
+template <class Scalar>
+std::string BasicRandomForest<Scalar>::getName() const {
+	return std::is_same<Scalar, double>::value ? "Random Forest (float64)" : "Random Forest";
 }
 
-void RandomForest::fit(const std::vector<float>& x_values, const std::vector<std::string>& columns, const std::vector<float>& y_values) {
+template <class Scalar>
+void BasicRandomForest<Scalar>::fit(const std::vector<float>& x_values, const std::vector<std::string>& columns, const std::vector<float>& y_values) {
 	if (x_values.empty() || y_values.empty() || columns.empty()) {
         	throw std::invalid_argument("Input vectors cannot be empty.");
     	}
@@ -213,14 +358,25 @@ void RandomForest::fit(const std::vector<float>& x_values, const std::vector<std
         	throw std::invalid_argument("The size of x_values is not a multiple of the number of columns.");
     	}
 
-        // since the internal model expects a single scalar target per row, it needs to be decoded
-        std::vector<double> targets_double;
-        targets_double.reserve(n_rows);
+    	fitView(MatrixView(x_values.data(), n_rows, n_cols), y_values);
+}
+
+template <class Scalar>
+void BasicRandomForest<Scalar>::fitView(const MatrixView& X, Span<const float> y_values) {
+	if (X.empty() || y_values.size == 0) {
+        	throw std::invalid_argument("Input vectors cannot be empty.");
+    	}
+
+    	const size_t n_rows = X.rows;
 
-        if (y_values.size() > n_rows) {
-		size_t n_target_cols = y_values.size() / n_rows;
+        // since the internal model expects a single scalar target per row, one-hot rows need to be decoded
+        std::vector<Scalar> targets;
 
-		if (y_values.size() % n_rows == 0 && n_target_cols > 1) { // check if it is a clean multiple 
+        if (y_values.size > n_rows) {
+		size_t n_target_cols = y_values.size / n_rows;
+
+		if (y_values.size % n_rows == 0 && n_target_cols > 1) { // check if it is a clean multiple 
+                	targets.reserve(n_rows);
                 	for (size_t i = 0; i < n_rows; ++i) {
                     		double maxVal = -std::numeric_limits<double>::infinity();
                     		int maxIdx = 0;
@@ -233,34 +389,30 @@ void RandomForest::fit(const std::vector<float>& x_values, const std::vector<std
                         		}
                     		}
                     		
-				targets_double.push_back(static_cast<double>(maxIdx));
+				targets.push_back(static_cast<Scalar>(maxIdx));
                 	}
             	} else { // error handling 
                 	throw std::invalid_argument("Number of samples in features and targets do not match (and not valid one-hot).");
             	}
 
-        } else if (y_values.size() == n_rows) { // 1-1 scalar mapping for targets 
-
-		for (float v : y_values) {
-                	targets_double.push_back(static_cast<double>(v));
+        } else if (y_values.size == n_rows) { // 1-1 scalar mapping for targets, read in place by the float32 trees
+		if constexpr (std::is_same<Scalar, float>::value) {
+                	this->fit(FeatureMatrix(X), y_values);
+                	return;
             	}
+		targets.assign(y_values.begin(), y_values.end());
 
         } else {
              	throw std::invalid_argument("Number of targets is less than number of feature rows.");
         }
 
-    	std::vector<std::vector<double>> features_double(n_rows, std::vector<double>(n_cols)); // reshape then convert to double 
-    	for (size_t i = 0; i < n_rows; ++i) {
-        	for (size_t j = 0; j < n_cols; ++j) {
-            		features_double[i][j] = static_cast<double>(x_values[i * n_cols + j]);
-        	}
-    	}
-
-    	this->fit(features_double, targets_double);
+    	// the trees read the row-major float buffer in place, no reshaped copy
+    	this->fit(FeatureMatrix(X), Span<const Scalar>(targets));
 }
 
 // predict method 
-std::vector<float> RandomForest::predict(const std::vector<float>& x_values, const std::vector<std::string>& columns) const {
+template <class Scalar>
+std::vector<float> BasicRandomForest<Scalar>::predict(const std::vector<float>& x_values, const std::vector<std::string>& columns) const {
 	if (x_values.empty() || columns.empty()) {
 		return {};
     	}
@@ -276,23 +428,38 @@ std::vector<float> RandomForest::predict(const std::vector<float>& x_values, con
         	throw std::invalid_argument("The size of x_values is not a multiple of the number of columns.");
     	}
 
-    	std::vector<float> all_predictions;
-    	all_predictions.reserve(n_rows);
+    	if (static_cast<int>(n_cols) != nFeatures) {
+        	throw std::invalid_argument("predict: input dimension does not match training data");
+    	}
 
-    	for (size_t i = 0; i < n_rows; ++i) {
-        	std::vector<double> single_feature_double; // row of floats to double 
-        	single_feature_double.reserve(n_cols);
-        	for (size_t j = 0; j < n_cols; ++j) {
-            		single_feature_double.push_back(static_cast<double>(x_values[i * n_cols + j]));
-        	}
+    	std::vector<float> all_predictions(n_rows);
+    	predictInto(MatrixView(x_values.data(), n_rows, n_cols), all_predictions); // handles the isClassification check
 
-        	if (static_cast<int>(single_feature_double.size()) != nFeatures) {
-            		throw std::invalid_argument("predict: input dimension does not match training data");
-        	}
+    	return all_predictions;
+}
 
-            // calls internal predict(std::vector<double>) which handles isClassification check
-            all_predictions.push_back(static_cast<float>(this->predict(single_feature_double)));
-    }
+template <class Scalar>
+void BasicRandomForest<Scalar>::predictInto(const MatrixView& X, Span<float> out) const {
+	if (!isFitted) {
+        	throw std::logic_error("predict: model is not fitted");
+    	}
 
-    return all_predictions;
+    	if (static_cast<int>(X.cols) != nFeatures) {
+        	throw std::invalid_argument("predict: input dimension does not match training data");
+    	}
+
+    	if (out.size != X.rows) {
+        	throw std::invalid_argument("predictInto: output size must match the number of rows");
+    	}
+
+    	const FeatureMatrix M(X);
+    	ThreadPool::shared().parallelChunks(X.rows, getPredictThreads(), 256, [&](std::size_t begin, std::size_t end) {
+        	thread_local std::vector<double> scores;
+        	scores.resize(end - begin);
+        	this->predict(M, begin, end, scores.data());
+        	for (std::size_t i = begin; i < end; ++i) out[i] = static_cast<float>(scores[i - begin]);
+    	});
 }
+
+template class BasicRandomForest<float>;
+template class BasicRandomForest<double>;
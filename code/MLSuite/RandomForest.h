@@ -4,19 +4,54 @@
 #include "IModel.h"
 #include <vector>
 #include <random>
+#include <memory>
 #include "DecisionTree.h"
+#include "ThreadPool.h"
+#include "PackedForest.h"
 
-class RandomForest : public IModel {
+// how many features each split considers: Count uses the maxFeatures constructor argument (0 => sqrt(p)),
+// Fraction uses ceil(fraction * p); every policy keeps at least one feature
+enum class MaxFeaturesPolicy { Count, Sqrt, Log2, Fraction, All };
+
+// Scalar is the precision of targets, thresholds and leaf values, see BasicDecisionTree
+template <class Scalar>
+class BasicRandomForest : public IModel {
     public:
-	RandomForest(int Estimators, int maxDepth, int minSamplesSplit, int maxFeatures, bool bootstrap, int randomState, bool isClassification = false);
+	BasicRandomForest(int Estimators, int maxDepth, int minSamplesSplit, int maxFeatures, bool bootstrap, int randomState, bool isClassification = false);
+        void fit(const FeatureMatrix& X, Span<const Scalar> Y);
+        // float64 targets, converted to Scalar once
+        void fit(const FeatureMatrix& X, const std::vector<double>& Y);
         void fit(const std::vector<std::vector<double>>& X, const std::vector<double>& Y);
         double predict(const std::vector<double>& X) const;
-        std::vector<DecisionTree> getTrees() {return trees;};
+        double predict(const FeatureMatrix& X, std::size_t row) const;
+        // predictions for rows [begin, end) of X through the batch traversal, out[row - begin]
+        void predict(const FeatureMatrix& X, std::size_t begin, std::size_t end, double* out) const;
+        std::vector<BasicDecisionTree<Scalar>> getTrees() {return trees;};
+
+        // split finding used by every tree, see SplitMode
+        void setSplitMode(SplitMode mode) { splitMode = mode; }
+        void setMaxBins(int bins);
+        SplitMode getSplitMode() const { return splitMode; }
+        int getMaxBins() const { return maxBins; }
+
+        void setMaxFeaturesPolicy(MaxFeaturesPolicy policy) { maxFeaturesPolicy = policy; }
+        void setMaxFeaturesFraction(double fraction);
+        MaxFeaturesPolicy getMaxFeaturesPolicy() const { return maxFeaturesPolicy; }
+        // features searched per split for p input features
+        int featuresPerSplit(int p) const;
+
+        // threads used to train trees in fit, <= 0 (the default, as for XGBoostModel) uses every hardware thread;
+        // the result does not depend on it
+        void setNumThreads(int threads) { numThreads = threads; }
+        int getNumThreads() const { return numThreads; }
 
 	// IModel interface methods
 	void fit(const std::vector<float>& x_values, const std::vector<std::string>& columns, const std::vector<float>& y_values) override;
 	std::vector<float> predict(const std::vector<float>& x_values, const std::vector<std::string>& columns) const override;
-	std::string getName() const override;
+	std::string getName() const override; // the float64 build is named "Random Forest (float64)"
+	// rows split over getPredictThreads(), no heap allocation once the per-thread scratch is warm
+	void predictInto(const MatrixView& X, Span<float> out) const override;
+	void fitView(const MatrixView& X, Span<const float> y) override;
     private:
         int nEstimators;
         int maxDepth;
@@ -26,14 +61,24 @@ class RandomForest : public IModel {
         int randomState;
         bool isClassification;
         bool isFitted = false;
+        SplitMode splitMode = SplitMode::Exact;
+        int maxBins = FeatureBins::kMaxBins;
+        int numThreads = 0;
+        MaxFeaturesPolicy maxFeaturesPolicy = MaxFeaturesPolicy::Count;
+        double maxFeaturesFraction = 1.0;
         int nFeatures = 0;
-        std::vector<DecisionTree> trees;
-        std::mt19937 internalRng;
-        void buildTree(const std::vector<std::vector<double>>& X, const std::vector<double>& Y);
-        std::vector<int> sampleBootstrap(int n);
-        std::vector<int> sampleFeatures(int p, int maxFeatures);
+        std::vector<BasicDecisionTree<Scalar>> trees;
+        PackedForest packed; // inference copy of trees, built at the end of fit
+        BasicDecisionTree<Scalar> buildTree(const FeatureMatrix& X, Span<const Scalar> Y,
+                               const std::shared_ptr<const FeatureBins>& bins, int treeIndex) const;
+        std::mt19937 treeRng(int treeIndex) const;
+        static std::vector<int> sampleBootstrap(int n, std::mt19937& rng);
+        static void sampleFeatures(int p, int k, std::mt19937& rng, std::vector<int>& order, std::vector<int>& features);
         std::vector<std::vector<double>> predictAllTrees(const std::vector<std::vector<double>>& X);
         std::vector<double> aggregateMean(const std::vector<double>& preds);
 };
 
+using RandomForest = BasicRandomForest<float>;
+using RandomForest64 = BasicRandomForest<double>;
+
 #endif
@@ -1,13 +1,19 @@
 #include "RandomForestBuilder.h"
+#include <stdexcept>
 
 RandomForestBuilder::RandomForestBuilder()
     : nEstimators(100),
       mMaxDepth(-1),
       mMinSamplesSplit(2),
       mMaxFeatures(0),
+      mMaxFeaturesPolicy(MaxFeaturesPolicy::Count),
+      mMaxFeaturesFraction(1.0),
       mBootstrap(true),
       mRandomState(0),
-      mIsClassification(false) {} 
+      mIsClassification(false),
+      mSplitMode(SplitMode::Exact),
+      mMaxBins(FeatureBins::kMaxBins),
+      mNumThreads(0) {} 
 
 RandomForestBuilder& RandomForestBuilder::setEstimators(int estimators) {
 	nEstimators = estimators;
@@ -29,6 +35,21 @@ RandomForestBuilder& RandomForestBuilder::setMaxFeatures(int maxFeatures) {
     	return *this;
 }
 
+RandomForestBuilder& RandomForestBuilder::setMaxFeaturesPolicy(MaxFeaturesPolicy policy) {
+    	mMaxFeaturesPolicy = policy;
+    	return *this;
+}
+
+// also selects MaxFeaturesPolicy::Fraction
+RandomForestBuilder& RandomForestBuilder::setMaxFeaturesFraction(double fraction) {
+    	if (!(fraction > 0.0 && fraction <= 1.0)) {
+        	throw std::invalid_argument("RandomForestBuilder: maxFeatures fraction must be in (0, 1]");
+    	}
+    	mMaxFeaturesFraction = fraction;
+    	mMaxFeaturesPolicy = MaxFeaturesPolicy::Fraction;
+    	return *this;
+}
+
 RandomForestBuilder& RandomForestBuilder::setBootstrap(bool bootstrap) {
     	mBootstrap = bootstrap;
     	return *this;
@@ -44,6 +65,34 @@ RandomForestBuilder& RandomForestBuilder::setIsClassification(bool isClassificat
     	return *this;
 }
 
-std::unique_ptr<RandomForest> RandomForestBuilder::build() {
-    	return std::make_unique<RandomForest>(nEstimators, mMaxDepth, mMinSamplesSplit, mMaxFeatures, mBootstrap, mRandomState, mIsClassification);
+RandomForestBuilder& RandomForestBuilder::setSplitMode(SplitMode splitMode) {
+    	mSplitMode = splitMode;
+    	return *this;
+}
+
+RandomForestBuilder& RandomForestBuilder::setMaxBins(int maxBins) {
+    	mMaxBins = maxBins;
+    	return *this;
+}
+
+RandomForestBuilder& RandomForestBuilder::setNumThreads(int numThreads) {
+    	mNumThreads = numThreads;
+    	return *this;
+}
+
+template <class Scalar>
+std::unique_ptr<BasicRandomForest<Scalar>> RandomForestBuilder::build() {
+    	auto model = std::make_unique<BasicRandomForest<Scalar>>(nEstimators, mMaxDepth, mMinSamplesSplit, mMaxFeatures, mBootstrap, mRandomState, mIsClassification);
+    	model->setSplitMode(mSplitMode);
+    	model->setMaxBins(mMaxBins);
+    	model->setNumThreads(mNumThreads);
+    	if (mMaxFeaturesPolicy == MaxFeaturesPolicy::Fraction) {
+        	model->setMaxFeaturesFraction(mMaxFeaturesFraction);
+    	} else {
+        	model->setMaxFeaturesPolicy(mMaxFeaturesPolicy);
+    	}
+    	return model;
 }
+
+template std::unique_ptr<RandomForest> RandomForestBuilder::build<float>();
+template std::unique_ptr<RandomForest64> RandomForestBuilder::build<double>();
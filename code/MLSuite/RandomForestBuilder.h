@@ -11,19 +11,32 @@ public:
     RandomForestBuilder& setMaxDepth(int maxDepth);
     RandomForestBuilder& setMinSamplesSplit(int minSamplesSplit);
     RandomForestBuilder& setMaxFeatures(int maxFeatures);
+    RandomForestBuilder& setMaxFeaturesPolicy(MaxFeaturesPolicy policy);
+    RandomForestBuilder& setMaxFeaturesFraction(double fraction);
     RandomForestBuilder& setBootstrap(bool bootstrap);
     RandomForestBuilder& setRandomState(int randomState);
     RandomForestBuilder& setIsClassification(bool isClassification); 
+    RandomForestBuilder& setSplitMode(SplitMode splitMode);
+    RandomForestBuilder& setMaxBins(int maxBins);
+    // fit threads, <= 0 (the default) uses every hardware thread, see RandomForest::setNumThreads
+    RandomForestBuilder& setNumThreads(int numThreads);
 
-    std::unique_ptr<RandomForest> build();
+    // float32 forest by default, build<double>() for a float64 one
+    template <class Scalar = float>
+    std::unique_ptr<BasicRandomForest<Scalar>> build();
 
 private:
     int nEstimators;
     int mMaxDepth;
     int mMinSamplesSplit;
     int mMaxFeatures;
+    MaxFeaturesPolicy mMaxFeaturesPolicy;
+    double mMaxFeaturesFraction;
     bool mBootstrap;
     int mRandomState;
     bool mIsClassification; 
+    SplitMode mSplitMode;
+    int mMaxBins;
+    int mNumThreads;
 };
 #endif // RANDOMFORESTBUILDER_H
@@ -11,24 +11,24 @@
 // contains all methods to benchmark performance metrics of a regression model, concrete Strategy implementation for BenchmarkStrategy
 namespace {
 
-double calculateMSE(const std::vector<float>& actual, const std::vector<float>& predicted) {
+double calculateMSE(Span<const float> actual, Span<const float> predicted) {
     double mse = 0.0;
-    if (actual.empty()) return 0.0;
-    for (size_t i = 0; i < actual.size(); ++i) {
+    if (actual.size == 0) return 0.0;
+    for (size_t i = 0; i < actual.size; ++i) {
         mse += std::pow(actual[i] - predicted[i], 2);
     }
-    return mse / actual.size();
+    return mse / actual.size;
 }
 
-double calculateR2(const std::vector<float>& actual, const std::vector<float>& predicted) {
-    if (actual.empty()) return 0.0;
+double calculateR2(Span<const float> actual, Span<const float> predicted) {
+    if (actual.size == 0) return 0.0;
     double sum_actual = std::accumulate(actual.begin(), actual.end(), 0.0);
-    double mean_actual = sum_actual / actual.size();
+    double mean_actual = sum_actual / actual.size;
 
     double ss_total = 0.0;
     double ss_res = 0.0;
 
-    for (size_t i = 0; i < actual.size(); ++i) {
+    for (size_t i = 0; i < actual.size; ++i) {
         ss_total += std::pow(actual[i] - mean_actual, 2);
         ss_res += std::pow(actual[i] - predicted[i], 2);
     }
@@ -39,6 +39,22 @@ double calculateR2(const std::vector<float>& actual, const std::vector<float>& p
 
     return 1.0 - (ss_res / ss_total);
 }
+
+void printResult(const BenchmarkResult& result) {
+    std::cout << "----------------------------------------" << std::endl;
+    std::cout << "       Regression Benchmark Results     " << std::endl;
+    std::cout << "----------------------------------------" << std::endl;
+    std::cout << "Model: " << result.modelName << std::endl;
+    std::cout << "Samples: " << result.numSamples << std::endl;
+    std::cout << "Fit time (ms): " << result.fitMillis << std::endl;
+    std::cout << "Predict time (ms): " << result.predictMillis << std::endl;
+    std::cout << "Predict throughput (rows/sec): " << result.predictRowsPerSec << " (" << result.predictThreads << " threads)" << std::endl;
+    std::cout << "Memory (bytes): " << result.memoryBytes << std::endl;
+    std::cout << "MSE: " << result.mse << std::endl;
+    std::cout << "RMSE: " << result.rmse << std::endl;
+    std::cout << "R-squared: " << result.r2 << std::endl;
+    std::cout << "----------------------------------------" << std::endl;
+}
 } // namespace
 
 BenchmarkResult RegressionBenchmark::execute(const IModel& model,
@@ -48,19 +64,27 @@ BenchmarkResult RegressionBenchmark::execute(const IModel& model,
     BenchmarkResult result;
     result.modelName = model.getName();
     result.taskType = "regression";
-    result.numSamples = actualData.get_data().size();
+    const Span<const float> actual = actualData.values();
+    result.numSamples = actual.size;
     result.fitMillis = fitMillis;
 
+    // the features are read in place (the mapped columns of a binary file too), one prediction per row
+    std::vector<float> predictions(xData.num_rows());
     const auto startPredict = std::chrono::high_resolution_clock::now();
-    std::vector<float> predictions = model.predict(xData.get_data(), xData.get_columns());
+    try {
+        model.predictInto(xData.view(), predictions);
+    } catch (const std::runtime_error& e) { // a model returning the wrong number of predictions
+        std::cerr << "Benchmark Error: " << e.what() << std::endl;
+        return result;
+    }
     const auto endPredict = std::chrono::high_resolution_clock::now();
     result.predictMillis = millisBetween(startPredict, endPredict);
+    result.predictThreads = model.getPredictThreads();
+    result.predictRowsPerSec = rowsPerSecond(predictions.size(), result.predictMillis);
 
     result.memoryBytes = static_cast<std::size_t>(currentMemoryUsageBytes());
 
-    const std::vector<float>& actual = actualData.get_data();
-
-    if (predictions.size() != actual.size()) {
+    if (predictions.size() != actual.size) {
         std::cerr << "Benchmark Error: Prediction size does not match actual size." << std::endl;
         return result;
     }
@@ -69,32 +93,82 @@ BenchmarkResult RegressionBenchmark::execute(const IModel& model,
     result.rmse = std::sqrt(result.mse);
     result.r2 = calculateR2(actual, predictions);
 
-    std::cout << "----------------------------------------" << std::endl;
-    std::cout << "       Regression Benchmark Results     " << std::endl;
-    std::cout << "----------------------------------------" << std::endl;
-    std::cout << "Model: " << result.modelName << std::endl;
-    std::cout << "Samples: " << result.numSamples << std::endl;
-    std::cout << "Fit time (ms): " << result.fitMillis << std::endl;
-    std::cout << "Predict time (ms): " << result.predictMillis << std::endl;
-    std::cout << "Memory (bytes): " << result.memoryBytes << std::endl;
-    std::cout << "MSE: " << result.mse << std::endl;
-    std::cout << "RMSE: " << result.rmse << std::endl;
-    std::cout << "R-squared: " << result.r2 << std::endl;
-    std::cout << "----------------------------------------" << std::endl;
+    printResult(result);
 
     return result;
 }
 
+BenchmarkResult RegressionBenchmark::executeStream(const IModel& model,
+                                                   DatasetStream& xStream,
+                                                   DatasetStream& yStream,
+                                                   double fitMillis) const {
+    BenchmarkResult result;
+    result.modelName = model.getName();
+    result.taskType = "regression";
+    result.fitMillis = fitMillis;
+    result.predictThreads = model.getPredictThreads();
+
+    // squared error and the actual variance (Welford) accumulate batch by batch
+    std::size_t count = 0;
+    double ssRes = 0.0, meanActual = 0.0, ssTotal = 0.0;
+    std::vector<float> predictions;
+    MatrixView xBatch, yBatch;
+    while (xStream.next(xBatch)) {
+        if (!yStream.next(yBatch) || yBatch.rows != xBatch.rows) {
+            std::cerr << "Benchmark Error: Prediction size does not match actual size." << std::endl;
+            return result;
+        }
+
+        predictions.resize(xBatch.rows);
+        const auto startPredict = std::chrono::high_resolution_clock::now();
+        model.predictInto(xBatch, predictions);
+        result.predictMillis += millisBetween(startPredict, std::chrono::high_resolution_clock::now());
+
+        for (std::size_t i = 0; i < xBatch.rows; ++i) {
+            const double actual = yBatch(i, 0);
+            ssRes += std::pow(actual - predictions[i], 2);
+            const double delta = actual - meanActual;
+            meanActual += delta / static_cast<double>(++count);
+            ssTotal += delta * (actual - meanActual);
+        }
+    }
+
+    if (yStream.next(yBatch)) {
+        std::cerr << "Benchmark Error: Prediction size does not match actual size." << std::endl;
+        return result;
+    }
+
+    result.numSamples = count;
+    result.predictRowsPerSec = rowsPerSecond(count, result.predictMillis);
+    result.memoryBytes = static_cast<std::size_t>(currentMemoryUsageBytes());
+    result.mse = count == 0 ? 0.0 : ssRes / static_cast<double>(count);
+    result.rmse = std::sqrt(result.mse);
+    if (count == 0) {
+        result.r2 = 0.0;
+    } else if (ssTotal == 0.0) {
+        result.r2 = (ssRes == 0.0) ? 1.0 : 0.0;
+    } else {
+        result.r2 = 1.0 - (ssRes / ssTotal);
+    }
+
+    printResult(result);
+    return result;
+}
+
 double RegressionBenchmark::evaluate(const IModel& model, 
                                      const Dataset& features, 
                                      const Dataset& targets) const {
-    std::vector<float> predictions = model.predict(features.get_data(), features.get_columns());
-    const std::vector<float>& actual = targets.get_data();
+    std::vector<float> predictions(features.num_rows());
+    model.predictInto(features.view(), predictions);
+    return evaluatePredictions(predictions, targets.values());
+}
 
-    if (predictions.size() != actual.size()) { // size safety check 
+double RegressionBenchmark::evaluatePredictions(Span<const float> predictions,
+                                                Span<const float> targets) const {
+    if (predictions.size != targets.size) { // size safety check 
         std::cerr << "evaluate: Prediction size mismatch." << std::endl;
         return std::numeric_limits<double>::infinity(); 
     }
 
-    return calculateMSE(actual, predictions);
+    return calculateMSE(targets, predictions);
 }
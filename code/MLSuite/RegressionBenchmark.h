@@ -10,9 +10,17 @@ public:
                             const Dataset& actualData,
                             double fitMillis = 0.0) const override;
 
+    BenchmarkResult executeStream(const IModel& model,
+                                  DatasetStream& xStream,
+                                  DatasetStream& yStream,
+                                  double fitMillis = 0.0) const override;
+
     double evaluate(const IModel& model, 
                     const Dataset& features, 
                     const Dataset& targets) const override;
+
+    double evaluatePredictions(Span<const float> predictions,
+                               Span<const float> targets) const override;
 };
 
 #endif // REGRESSIONBENCHMARK_H
@@ -0,0 +1,114 @@
+#include "ThreadPool.h"
+#include <algorithm>
+#include <atomic>
+#include <exception>
+
+struct ThreadPool::Job {
+	const std::function<void(std::size_t)>* fn = nullptr;
+	std::atomic<std::size_t> next{0};
+	std::size_t end = 0;
+	std::atomic<std::size_t> remaining{0};
+	std::exception_ptr error;
+	std::mutex errorMutex;
+};
+
+int ThreadPool::resolveThreadCount(int numThreads) {
+	if (numThreads > 0) return numThreads;
+	const unsigned hw = std::thread::hardware_concurrency();
+	return hw == 0 ? 1 : static_cast<int>(hw);
+}
+
+ThreadPool::ThreadPool(int numThreads) {
+	const int total = resolveThreadCount(numThreads);
+	workers.reserve(static_cast<std::size_t>(total - 1));
+	for (int t = 1; t < total; ++t) {
+		workers.emplace_back([this] { workerLoop(); });
+	}
+}
+
+ThreadPool::~ThreadPool() {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	workAvailable.notify_all();
+	for (auto& worker : workers) worker.join();
+}
+
+// claim indices of a job until none are left; every finished index is counted so the owner knows when to return
+void ThreadPool::runJob(Job& job) {
+	std::size_t i;
+	while ((i = job.next.fetch_add(1)) < job.end) {
+		try {
+			(*job.fn)(i);
+		} catch (...) {
+			std::lock_guard<std::mutex> lock(job.errorMutex);
+			if (!job.error) job.error = std::current_exception();
+		}
+		if (job.remaining.fetch_sub(1) == 1) {
+			std::lock_guard<std::mutex> lock(mutex);
+			jobFinished.notify_all();
+		}
+	}
+}
+
+// pops one queued job entry and helps with it, the lock is released while it runs
+bool ThreadPool::runQueuedJob(std::unique_lock<std::mutex>& lock) {
+	if (queue.empty()) return false;
+	std::shared_ptr<Job> job = std::move(queue.front());
+	queue.pop_front();
+	lock.unlock();
+	runJob(*job);
+	lock.lock();
+	return true;
+}
+
+void ThreadPool::workerLoop() {
+	std::unique_lock<std::mutex> lock(mutex);
+	while (true) {
+		workAvailable.wait(lock, [this] { return stopping || !queue.empty(); });
+		if (stopping && queue.empty()) return;
+		runQueuedJob(lock);
+	}
+}
+
+ThreadPool& ThreadPool::shared() {
+	static ThreadPool pool(0);
+	return pool;
+}
+
+void ThreadPool::parallelFor(std::size_t begin, std::size_t end, const std::function<void(std::size_t)>& fn) {
+	if (begin >= end) return;
+
+	const std::size_t count = end - begin;
+	if (workers.empty() || count == 1) {
+		for (std::size_t i = begin; i < end; ++i) fn(i);
+		return;
+	}
+
+	auto job = std::make_shared<Job>();
+	const std::function<void(std::size_t)> shifted = [&fn, begin](std::size_t i) { fn(begin + i); };
+	job->fn = &shifted;
+	job->end = count;
+	job->remaining = count;
+
+	const std::size_t helpers = std::min(count - 1, workers.size());
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		for (std::size_t h = 0; h < helpers; ++h) queue.push_back(job);
+	}
+	workAvailable.notify_all();
+
+	runJob(*job);
+
+	// help with whatever else is queued (including nested jobs) until the last claimed index of this job is done
+	std::unique_lock<std::mutex> lock(mutex);
+	while (job->remaining.load() != 0) {
+		if (!runQueuedJob(lock)) {
+			jobFinished.wait(lock, [&] { return job->remaining.load() == 0 || !queue.empty(); });
+		}
+	}
+	lock.unlock();
+
+	if (job->error) std::rethrow_exception(job->error);
+}
@@ -0,0 +1,70 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// ThreadPool runs index ranges on a fixed set of worker threads (used for per-tree training in RandomForest).
+// The thread calling parallelFor works on its own range and runs other queued work while it waits, so
+// parallelFor may be nested from inside a task without deadlocking. numThreads counts the calling thread;
+// 1 runs everything inline and <= 0 uses every hardware thread.
+class ThreadPool {
+public:
+	explicit ThreadPool(int numThreads = 1);
+	~ThreadPool();
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	int size() const { return static_cast<int>(workers.size()) + 1; }
+
+	// calls fn(i) for every i in [begin, end), returns when all calls finished and rethrows the first exception
+	void parallelFor(std::size_t begin, std::size_t end, const std::function<void(std::size_t)>& fn);
+
+	// splits [0, n) into at most maxChunks ranges of at least minChunk rows and calls fn(begin, end) for each in parallel;
+	// a single chunk runs inline without touching the pool (no allocation)
+	template <class Fn>
+	void parallelChunks(std::size_t n, int maxChunks, std::size_t minChunk, Fn&& fn) {
+		if (n == 0) return;
+		const std::size_t byRows = (n + minChunk - 1) / (minChunk == 0 ? 1 : minChunk);
+		const std::size_t chunks = std::max<std::size_t>(1, std::min<std::size_t>(byRows, maxChunks > 1 ? maxChunks : 1));
+		if (chunks == 1 || workers.empty()) {
+			fn(std::size_t{0}, n);
+			return;
+		}
+		const std::size_t chunkSize = (n + chunks - 1) / chunks;
+		parallelFor(0, chunks, [&](std::size_t c) {
+			const std::size_t begin = c * chunkSize;
+			const std::size_t end = std::min(n, begin + chunkSize);
+			if (begin < end) fn(begin, end);
+		});
+	}
+
+	static int resolveThreadCount(int numThreads);
+
+	// process-wide pool with one thread per hardware thread, used by batch predict
+	static ThreadPool& shared();
+
+private:
+	struct Job;
+
+	std::vector<std::thread> workers;
+	std::deque<std::shared_ptr<Job>> queue; // one entry per helper a job asked for
+	std::mutex mutex;
+	std::condition_variable workAvailable;
+	std::condition_variable jobFinished;
+	bool stopping = false;
+
+	void workerLoop();
+	void runJob(Job& job);
+	bool runQueuedJob(std::unique_lock<std::mutex>& lock);
+};
+
+#endif
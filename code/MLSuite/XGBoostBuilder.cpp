@@ -1,4 +1,5 @@
 #include "XGBoostBuilder.h"
+#include <stdexcept>
 
 XGBoostBuilder::XGBoostBuilder()
     : nEstimators(100),
@@ -39,11 +40,91 @@ XGBoostBuilder& XGBoostBuilder::setRegularization(const std::string& regularizat
     	return *this;
 }
 
+XGBoostBuilder& XGBoostBuilder::setLambda(float lambdaValue) {
+    	if (lambdaValue < 0.0f) {
+        	throw std::invalid_argument("lambda must be >= 0.");
+    	}
+    	lambda = lambdaValue;
+    	return *this;
+}
+
+XGBoostBuilder& XGBoostBuilder::setMaxDeltaStep(float stepValue) {
+    	if (stepValue < 0.0f) {
+        	throw std::invalid_argument("maxDeltaStep must be >= 0.");
+    	}
+    	maxDeltaStep = stepValue;
+    	return *this;
+}
+
 XGBoostBuilder& XGBoostBuilder::setIsClassification(bool isClassificationValue) {
     isClassification = isClassificationValue;
     return *this;
 }
 
-std::unique_ptr<XGBoostModel> XGBoostBuilder::build() {
-    	return std::make_unique<XGBoostModel>(nEstimators, learningRate, maxDepth, subsampleRatio, gamma, regularization, isClassification);
-}
\ No newline at end of file
+XGBoostBuilder& XGBoostBuilder::setSplitMode(SplitMode splitModeValue) {
+    splitMode = splitModeValue;
+    return *this;
+}
+
+XGBoostBuilder& XGBoostBuilder::setGrowth(TreeGrowth growthValue) {
+    growth = growthValue;
+    return *this;
+}
+
+XGBoostBuilder& XGBoostBuilder::setMaxBins(int maxBinsValue) {
+    if (maxBinsValue < 2 || maxBinsValue > FeatureBins::kMaxBins) {
+        throw std::invalid_argument("maxBins must be in [2, 256].");
+    }
+    maxBins = maxBinsValue;
+    return *this;
+}
+
+XGBoostBuilder& XGBoostBuilder::setNumThreads(int numThreadsValue) {
+    numThreads = numThreadsValue;
+    return *this;
+}
+
+XGBoostBuilder& XGBoostBuilder::setValidation(const Dataset& xVal, const Dataset& yVal) {
+    validationFeatures = &xVal;
+    validationTargets = &yVal;
+    return *this;
+}
+
+XGBoostBuilder& XGBoostBuilder::setEvalMetric(const BenchmarkStrategy& metric) {
+    evalMetric = &metric;
+    return *this;
+}
+
+XGBoostBuilder& XGBoostBuilder::setEvalLogLoss() {
+    evalLogLoss = true;
+    return *this;
+}
+
+XGBoostBuilder& XGBoostBuilder::setEarlyStoppingRounds(int rounds) {
+    earlyStoppingRounds = rounds;
+    return *this;
+}
+
+template <class Scalar>
+std::unique_ptr<BasicXGBoostModel<Scalar>> XGBoostBuilder::build() {
+    	auto model = std::make_unique<BasicXGBoostModel<Scalar>>(nEstimators, learningRate, maxDepth, subsampleRatio, gamma, regularization, isClassification);
+    	model->setSplitMode(splitMode);
+    	model->setGrowth(growth);
+    	model->setMaxBins(maxBins);
+    	model->setNumThreads(numThreads);
+    	model->setLambda(lambda);
+    	model->setMaxDeltaStep(maxDeltaStep);
+    	if (validationFeatures) {
+        	if (evalMetric) {
+            	model->setValidation(*validationFeatures, *validationTargets, *evalMetric, earlyStoppingRounds);
+        	} else if (evalLogLoss) {
+            	model->setValidation(*validationFeatures, *validationTargets, earlyStoppingRounds);
+        	} else {
+            	throw std::invalid_argument("A validation set needs an eval metric (setEvalMetric or setEvalLogLoss).");
+        	}
+    	}
+    	return model;
+}
+
+template std::unique_ptr<XGBoostModel> XGBoostBuilder::build<float>();
+template std::unique_ptr<XGBoostModel64> XGBoostBuilder::build<double>();
@@ -15,9 +15,25 @@ public:
     	XGBoostBuilder& setSubsampleRatio(float ratioValue);
     	XGBoostBuilder& setGamma(float gammaValue);
     	XGBoostBuilder& setRegularization(const std::string& regularizationType);
+    	XGBoostBuilder& setLambda(float lambdaValue);
+    	XGBoostBuilder& setMaxDeltaStep(float stepValue);
         XGBoostBuilder& setIsClassification(bool isClassification);
+        XGBoostBuilder& setSplitMode(SplitMode splitModeValue);
+        XGBoostBuilder& setGrowth(TreeGrowth growthValue);
+        XGBoostBuilder& setMaxBins(int maxBinsValue);
+        // fit threads, <= 0 (the default) uses every hardware thread, see XGBoostModel::setNumThreads
+        XGBoostBuilder& setNumThreads(int numThreadsValue);
+        // early stopping on a validation pair scored with metric (e.g. RegressionBenchmark), see XGBoostModel::setValidation;
+        // the datasets and the metric are borrowed by the built model
+        XGBoostBuilder& setValidation(const Dataset& xVal, const Dataset& yVal);
+        XGBoostBuilder& setEvalMetric(const BenchmarkStrategy& metric);
+        // classifiers only: score the validation set with its log loss instead of a metric
+        XGBoostBuilder& setEvalLogLoss();
+        XGBoostBuilder& setEarlyStoppingRounds(int rounds);
 
-    	std::unique_ptr<XGBoostModel> build();
+    	// float32 model by default, build<double>() for a float64 one
+    	template <class Scalar = float>
+    	std::unique_ptr<BasicXGBoostModel<Scalar>> build();
 
 private:
     	int nEstimators;
@@ -26,7 +42,18 @@ private:
     	float subsampleRatio;
     	float gamma;
     	std::string regularization;
+    	float lambda = 1.0f;
+    	float maxDeltaStep = 0.0f;
         bool isClassification = false;
+        SplitMode splitMode = SplitMode::Exact;
+        TreeGrowth growth = TreeGrowth::DepthFirst;
+        int maxBins = FeatureBins::kMaxBins;
+        int numThreads = 0;
+        const Dataset* validationFeatures = nullptr;
+        const Dataset* validationTargets = nullptr;
+        const BenchmarkStrategy* evalMetric = nullptr;
+        bool evalLogLoss = false;
+        int earlyStoppingRounds = 0;
 };
 
 #endif 
@@ -2,18 +2,76 @@
 
 #include <algorithm>
 #include <cmath>
+#include <limits>
 #include <numeric>
 #include <random>
 #include <stdexcept>
+#include "ThreadPool.h"
 
 namespace {
     // sigmoid function for binary classification
     inline double sigmoid(double x) {
         return 1.0 / (1.0 + std::exp(-x));
     }
+
+    // softmax of k class scores in place, shifted by the largest so exp never overflows
+    template <class T>
+    void softmax(T* p, int k) {
+        const double top = *std::max_element(p, p + k);
+        double total = 0.0;
+        for (int c = 0; c < k; ++c) {
+            p[c] = static_cast<T>(std::exp(static_cast<double>(p[c]) - top));
+            total += p[c];
+        }
+        for (int c = 0; c < k; ++c) p[c] = static_cast<T>(p[c] / total);
+    }
+
+    // softmax log loss of rows [begin, end) from their row-major scores (k per row): gradient = p_c - [y == c] and
+    // hessian = p_c (1 - p_c), written class-major (class c of row i at c * n + i). The probabilities go through a
+    // reused class-major block, so the max, exp and normalize steps each run over contiguous rows of one class.
+    template <class T>
+    void softmaxGradients(const T* scores, const int* classIds, int k, std::size_t n, std::size_t begin, std::size_t end,
+                          T* gradients, T* hessians) {
+        constexpr std::size_t kBlock = 256;
+        thread_local std::vector<double> p, top, total;
+        p.resize(kBlock * k);
+        top.resize(kBlock);
+        total.resize(kBlock);
+        for (std::size_t first = begin; first < end; first += kBlock) {
+            const std::size_t m = std::min(kBlock, end - first);
+            for (int c = 0; c < k; ++c) {
+                double* pc = p.data() + c * m;
+                for (std::size_t r = 0; r < m; ++r) pc[r] = static_cast<double>(scores[(first + r) * k + c]);
+            }
+            std::fill(top.begin(), top.begin() + m, -std::numeric_limits<double>::infinity());
+            std::fill(total.begin(), total.begin() + m, 0.0);
+            for (int c = 0; c < k; ++c) {
+                const double* pc = p.data() + c * m;
+                for (std::size_t r = 0; r < m; ++r) top[r] = std::max(top[r], pc[r]);
+            }
+            for (int c = 0; c < k; ++c) {
+                double* pc = p.data() + c * m;
+                for (std::size_t r = 0; r < m; ++r) {
+                    pc[r] = std::exp(pc[r] - top[r]);
+                    total[r] += pc[r];
+                }
+            }
+            for (int c = 0; c < k; ++c) {
+                const double* pc = p.data() + c * m;
+                T* g = gradients + c * n + first;
+                T* h = hessians + c * n + first;
+                for (std::size_t r = 0; r < m; ++r) {
+                    const double q = pc[r] / total[r];
+                    g[r] = static_cast<T>(q - (classIds[first + r] == c ? 1.0 : 0.0));
+                    h[r] = static_cast<T>(q * (1.0 - q));
+                }
+            }
+        }
+    }
 }
 
-XGBoostModel::XGBoostModel(int nEstimatorsValue,
+template <class Scalar>
+BasicXGBoostModel<Scalar>::BasicXGBoostModel(int nEstimatorsValue,
                            float learningRateValue,
                            int maxDepthValue,
                            float subsampleRatioValue,
@@ -45,9 +103,59 @@ XGBoostModel::XGBoostModel(int nEstimatorsValue,
     	}
 }
 
-void XGBoostModel::fit(const std::vector<std::vector<double>>& X, const std::vector<double>& Y) {
-    	const size_t sampleCount = Y.size();
-    	if (sampleCount == 0 || X.empty() || X.size() != sampleCount) {
+// "None", "L1" or "L2" applies lambda to the leaf weights as GradientParams::alpha or ::lambda
+template <class Scalar>
+GradientParams BasicXGBoostModel<Scalar>::gradientParams() const {
+	if (regularization != "None" && regularization != "L2" && regularization != "L1") {
+		throw std::invalid_argument("Invalid regularization type. Must be 'None', 'L1', or 'L2'.");
+	}
+	if (lambda < 0.0f || gamma < 0.0f || maxDeltaStep < 0.0f) {
+		throw std::invalid_argument("lambda, gamma and maxDeltaStep must be >= 0.");
+	}
+	GradientParams params;
+	params.lambda = (regularization == "L2") ? lambda : 0.0;
+	params.alpha = (regularization == "L1") ? lambda : 0.0;
+	params.gamma = gamma;
+	params.maxDeltaStep = maxDeltaStep;
+	return params;
+}
+
+template <class Scalar>
+void BasicXGBoostModel<Scalar>::setValidation(const Dataset& xVal, const Dataset& yVal, const BenchmarkStrategy& metric, int rounds) {
+	if (xVal.num_rows() == 0 || xVal.num_rows() != yVal.num_rows()) {
+		throw std::invalid_argument("setValidation: validation features and targets must be non-empty and have matching rows.");
+	}
+	validationFeatures = &xVal;
+	validationTargets = &yVal;
+	evalMetric = &metric;
+	earlyStoppingRounds = rounds;
+}
+
+template <class Scalar>
+void BasicXGBoostModel<Scalar>::setValidation(const Dataset& xVal, const Dataset& yVal, int rounds) {
+	if (!isClassification) {
+		throw std::invalid_argument("setValidation: log loss validation needs a classifier, pass a metric for regression.");
+	}
+	if (xVal.num_rows() == 0 || xVal.num_rows() != yVal.num_rows()) {
+		throw std::invalid_argument("setValidation: validation features and targets must be non-empty and have matching rows.");
+	}
+	validationFeatures = &xVal;
+	validationTargets = &yVal;
+	evalMetric = nullptr;
+	earlyStoppingRounds = rounds;
+}
+
+template <class Scalar>
+void BasicXGBoostModel<Scalar>::clearValidation() {
+	validationFeatures = nullptr;
+	validationTargets = nullptr;
+	evalMetric = nullptr;
+	earlyStoppingRounds = 0;
+}
+
+template <class Scalar>
+void BasicXGBoostModel<Scalar>::fit(const std::vector<std::vector<double>>& X, const std::vector<double>& Y) {
+    	if (X.empty() || X.size() != Y.size()) {
         	throw std::invalid_argument("X and Y must be non-empty and have matching rows.");
     	}
 
@@ -55,88 +163,399 @@ void XGBoostModel::fit(const std::vector<std::vector<double>>& X, const std::vec
         	throw std::invalid_argument("X must contain at least one feature.");
     	}
 
-    	trees.clear();
-    	trees.reserve(static_cast<size_t>(nEstimators));
+    	fit(FeatureMatrix(X), Y);
+}
+
+template <class Scalar>
+void BasicXGBoostModel<Scalar>::fit(const FeatureMatrix& X, const std::vector<double>& Y) {
+	if constexpr (std::is_same<Scalar, double>::value) {
+		fit(X, Span<const double>(Y));
+	} else {
+		const std::vector<Scalar> targets(Y.begin(), Y.end());
+		fit(X, Span<const Scalar>(targets));
+	}
+}
+
+template <class Scalar>
+void BasicXGBoostModel<Scalar>::fit(const FeatureMatrix& X, Span<const Scalar> Y) {
+    	const size_t sampleCount = Y.size;
+    	if (sampleCount == 0 || X.rows() != sampleCount) {
+        	throw std::invalid_argument("X and Y must be non-empty and have matching rows.");
+    	}
+
+    	if (X.cols() == 0) {
+        	throw std::invalid_argument("X must contain at least one feature.");
+    	}
 
-        if (isClassification) {
+    	const GradientParams params = gradientParams();
+    	nFeatures = static_cast<int>(X.cols());
+    	trees.clear();
+    	validationScores.clear();
+
+    	// validation rows keep their raw scores, each round adds only the new tree
+    	const bool validate = validationFeatures != nullptr;
+    	FeatureMatrix validationX;
+    	Span<const float> validationY;
+    	std::vector<double> validationRaw;
+    	std::vector<float> validationOut;
+    	std::vector<int> validationIds;
+    	if (validate) {
+    		validationX = FeatureMatrix(*validationFeatures);
+    		validationY = validationTargets->values();
+    		if (validationX.cols() != X.cols() || validationX.rows() != validationY.size) {
+    			throw std::invalid_argument("fit: the validation set must have the training features and one target per row.");
+    		}
+    		validationScores.reserve(static_cast<size_t>(nEstimators));
+    	}
+    	double bestScore = std::numeric_limits<double>::infinity();
+    	bestIteration = 0;
+
+    	// more than two labels: K = outputs() trees per round, one per class, on softmax gradients
+    	classLabels.clear();
+    	if (isClassification) {
+    		std::vector<double> labels(Y.begin(), Y.end());
+    		std::sort(labels.begin(), labels.end());
+    		labels.erase(std::unique(labels.begin(), labels.end()), labels.end());
+    		if (labels.size() > 2) classLabels = std::move(labels);
+    	}
+    	const int K = outputs();
+    	std::vector<int> classIds;
+    	std::vector<double> base(K);
+    	trees.reserve(static_cast<size_t>(nEstimators) * K);
+
+        if (K > 1) {
+            // class priors as base scores, log(p_k) up to the constant softmax ignores
+            classIds.resize(sampleCount);
+            std::vector<double> counts(K, 0.0);
+            for (size_t i = 0; i < sampleCount; ++i) {
+                classIds[i] = static_cast<int>(std::lower_bound(classLabels.begin(), classLabels.end(), static_cast<double>(Y[i])) - classLabels.begin());
+                counts[classIds[i]] += 1.0;
+            }
+            for (int k = 0; k < K; ++k) base[k] = std::log(std::max(1e-6, counts[k] / sampleCount));
+        } else if (isClassification) {
             // using 0.0 for simplicity or log-odds of mean.
             double posCount = 0.0;
-            for(double y : Y) if(y > 0.5) posCount++;
+            for(Scalar y : Y) if(y > 0.5) posCount++;
             double prob = posCount / sampleCount;
             
             // prevent log(0)
             prob = std::max(1e-6, std::min(1.0 - 1e-6, prob));
-            initialBias = std::log(prob / (1.0 - prob));
+            base[0] = std::log(prob / (1.0 - prob));
         } else {
     	    double meanTarget = std::accumulate(Y.begin(), Y.end(), 0.0) / static_cast<double>(sampleCount);
-    	    initialBias = meanTarget;
+    	    base[0] = meanTarget;
         }
+        initialBias = (K == 1) ? base[0] : 0.0;
+        classBias = (K == 1) ? std::vector<double>() : base;
 
-    	std::vector<double> predictions(sampleCount, initialBias);
-    	std::vector<double> residuals(sampleCount);
+    	// raw scores row by row (predictions[i * K + k]), gradients and hessians class by class so each tree reads one span
+    	std::vector<Scalar> predictions(sampleCount * K);
+    	for (size_t i = 0; i < sampleCount; ++i) {
+    		for (int k = 0; k < K; ++k) predictions[i * K + k] = static_cast<Scalar>(base[k]);
+    	}
+    	if (validate) {
+    		validationRaw.resize(validationX.rows() * K);
+    		for (size_t i = 0; i < validationX.rows(); ++i) {
+    			std::copy(base.begin(), base.end(), validationRaw.begin() + i * K);
+    		}
+    		validationOut.resize(validationX.rows());
+    		if (!evalMetric) { // the log loss reads every row's class, looked up here once instead of every round
+    			validationIds.resize(validationY.size);
+    			for (size_t i = 0; i < validationY.size; ++i) {
+    				if (K == 1) {
+    					validationIds[i] = validationY[i] > 0.5f ? 1 : 0;
+    					continue;
+    				}
+    				const auto label = std::lower_bound(classLabels.begin(), classLabels.end(), static_cast<double>(validationY[i]));
+    				validationIds[i] = (label != classLabels.end() && *label == validationY[i]) ? static_cast<int>(label - classLabels.begin()) : -1;
+    			}
+    		}
+    	}
+    	std::vector<Scalar> gradients(sampleCount * K), hessians(sampleCount * K, Scalar(1));
 	
 	    std::mt19937 rng(42);
 
+	    const int threads = ThreadPool::resolveThreadCount(numThreads);
+	    std::vector<Scalar> leafValues(sampleCount);  // leaf of every sampled row, reported by the tree as it grows
+
+	    // rows are subsampled as a 0/1 count per row over the full X, no row is copied; empty counts every row once
+	    size_t subsampleSize = static_cast<size_t>(std::ceil(subsampleRatio * static_cast<float>(sampleCount)));
+	    subsampleSize = std::max<size_t>(1, std::min(subsampleSize, sampleCount));
+	    std::vector<int> indices;
+	    std::vector<int> sampleCounts;
+	    if (subsampleSize < sampleCount) {
+	    	indices.resize(sampleCount);
+	    	std::iota(indices.begin(), indices.end(), 0);
+	    	sampleCounts.assign(sampleCount, 0);
+	    }
+
+	    // X is the same every round, so Histogram quantizes it once for all trees
+	    std::shared_ptr<const FeatureBins> bins;
+	    if (splitMode == SplitMode::Histogram) {
+	    	bins = std::make_shared<const FeatureBins>(X, maxBins);
+	    }
+
     	for (int treeIndex = 0; treeIndex < nEstimators; ++treeIndex) {
-        	for (size_t i = 0; i < sampleCount; ++i) {
-                if (isClassification) {
-                    double prob = sigmoid(predictions[i]); // fit the tree to the gradients using log loss 
-                    residuals[i] = Y[i] - prob; 
-                } else {
-            		residuals[i] = Y[i] - predictions[i]; // MSE: gradient = y - pred
-                }
+        	ThreadPool::shared().parallelChunks(sampleCount, threads, 4096, [&](std::size_t begin, std::size_t end) {
+            	if (K > 1) {
+                	softmaxGradients(predictions.data(), classIds.data(), K, sampleCount, begin, end, gradients.data(), hessians.data());
+                	return;
+            	}
+            	for (size_t i = begin; i < end; ++i) {
+                	if (isClassification) {
+                    	double prob = sigmoid(predictions[i]); // log loss: gradient = p - y, hessian = p (1 - p)
+                    	gradients[i] = static_cast<Scalar>(prob - Y[i]);
+                    	hessians[i] = static_cast<Scalar>(prob * (1.0 - prob));
+                	} else {
+            			gradients[i] = predictions[i] - Y[i]; // squared error: gradient = pred - y, hessian = 1
+                	}
+            	}
+        	});
+
+        	if (!sampleCounts.empty()) {
+            	// partial Fisher-Yates: the first subsampleSize entries become a fresh uniform sample, O(subsampleSize)
+            	for (size_t k = 0; k < subsampleSize; ++k) sampleCounts[static_cast<size_t>(indices[k])] = 0;
+            	for (size_t k = 0; k < subsampleSize; ++k) {
+            		std::uniform_int_distribution<size_t> pick(k, sampleCount - 1);
+            		std::swap(indices[k], indices[pick(rng)]);
+            		sampleCounts[static_cast<size_t>(indices[k])] = 1;
+            	}
         	}
 
-        	std::vector<size_t> indices(sampleCount);
-        	std::iota(indices.begin(), indices.end(), 0);
-        	std::shuffle(indices.begin(), indices.end(), rng);
-
-        	size_t subsampleSize = static_cast<size_t>(std::ceil(subsampleRatio * static_cast<float>(sampleCount)));
-        	subsampleSize = std::max<size_t>(1, std::min(subsampleSize, sampleCount));
-
-        	std::vector<std::vector<double>> featureSubset;
-        	std::vector<double> residualSubset;
-        	featureSubset.reserve(subsampleSize);
-        	residualSubset.reserve(subsampleSize);
+        	// one tree per class on the same sample
+        	for (int k = 0; k < K; ++k) {
+            	BasicDecisionTree<Scalar> tree(maxDepth, 2, false); 
+            	tree.setSplitMode(splitMode);
+            	tree.setGrowth(growth);
+            	tree.setMaxBins(maxBins);
+            	tree.setFeatureBins(bins);
+            	tree.setNumThreads(threads);
+            	tree.setLeafValueOutput(Span<Scalar>(leafValues));
+            	tree.fitGradients(X, Span<const Scalar>(gradients.data() + k * sampleCount, sampleCount),
+            	                  Span<const Scalar>(hessians.data() + k * sampleCount, sampleCount), params, sampleCounts);
+            	trees.push_back(std::move(tree));
+
+            	// the new tree with the learning rate folded in, for the rows that still need a traversal
+            	PackedForest step;
+            	step.addTree(trees.back(), static_cast<double>(learningRate));
+
+            	// sampled rows move by the value of the leaf they were routed to while the tree grew, O(1) per row
+            	ThreadPool::shared().parallelChunks(sampleCount, threads, 4096, [&](std::size_t begin, std::size_t end) {
+                	for (size_t i = begin; i < end; ++i) {
+                		if (sampleCounts.empty() || sampleCounts[i]) {
+                			predictions[i * K + k] += static_cast<Scalar>(static_cast<double>(learningRate) * static_cast<double>(leafValues[i]));
+                		}
+                	}
+            	});
+
+            	// the rows left out of this round, indices[subsampleSize, n), go through the batch traversal
+            	if (!sampleCounts.empty()) {
+                	const int* outOfSample = indices.data() + subsampleSize;
+                	ThreadPool::shared().parallelChunks(sampleCount - subsampleSize, threads, 256, [&](std::size_t begin, std::size_t end) {
+                    	thread_local std::vector<double> steps;
+                    	steps.resize(end - begin);
+                    	step.sumsAt(X, outOfSample + begin, end - begin, steps.data());
+                    	for (size_t j = begin; j < end; ++j) {
+                    		predictions[static_cast<size_t>(outOfSample[j]) * K + k] += static_cast<Scalar>(steps[j - begin]);
+                    	}
+                	});
+            	}
+
+            	if (validate) {
+                	ThreadPool::shared().parallelChunks(validationX.rows(), threads, 256, [&](std::size_t begin, std::size_t end) {
+                    	thread_local std::vector<double> steps;
+                    	steps.resize(end - begin);
+                    	step.sums(validationX, begin, end, steps.data());
+                    	for (size_t i = begin; i < end; ++i) validationRaw[i * K + k] += steps[i - begin];
+                	});
+            	}
+        	}
 
-        	for (size_t i = 0; i < subsampleSize; ++i) {
-            		size_t rowIndex = indices[i];
-            		featureSubset.push_back(X[rowIndex]);
-            		residualSubset.push_back(residuals[rowIndex]);
+        	if (validate) {
+            	double score;
+            	if (evalMetric) {
+            		for (size_t i = 0; i < validationX.rows(); ++i) {
+            			validationOut[i] = static_cast<float>(outputOf(&validationRaw[i * K]));
+            		}
+            		score = evalMetric->evaluatePredictions(validationOut, validationY);
+            	} else {
+            		score = logLoss(validationRaw, validationIds);
+            	}
+            	validationScores.push_back(score);
+            	if (score < bestScore) {
+                	bestScore = score;
+                	bestIteration = treeIndex + 1;
+            	} else if (earlyStoppingRounds > 0 && treeIndex + 1 - bestIteration >= earlyStoppingRounds) {
+                	break;
+            	}
         	}
+    	}
 
-            DecisionTree tree(maxDepth, 2, false); 
-        	tree.fit(featureSubset, residualSubset);
-        	trees.push_back(std::move(tree));
+    	// truncate to the best validation round (all of them when no score was ever finite)
+    	if (validate && bestIteration > 0) {
+        	trees.erase(trees.begin() + static_cast<std::ptrdiff_t>(bestIteration) * K, trees.end());
+    	}
+    	bestIteration = static_cast<int>(trees.size()) / K;
 
-        	for (size_t i = 0; i < sampleCount; ++i) {
-            		double treePrediction = trees.back().predict(X[i]);
-            		predictions[i] += static_cast<double>(learningRate) * treePrediction;
-        	}
+    	packed.clear();
+    	classForests.assign(K > 1 ? K : 0, PackedForest());
+    	for (std::size_t t = 0; t < trees.size(); ++t) {
+        	PackedForest& forest = (K > 1) ? classForests[t % K] : packed;
+        	forest.addTree(trees[t], static_cast<double>(learningRate));
     	}
 
     	isFitted = true;
 }
 
-double XGBoostModel::predict(const std::vector<double>& input) const {
+template <class Scalar>
+double BasicXGBoostModel<Scalar>::outputOf(const double* scores) const {
+	if (!classLabels.empty()) {
+		return classLabels[std::max_element(scores, scores + classLabels.size()) - scores];
+	}
+	if (isClassification) { // return binary 1 or 0 depending on probability 
+		return (sigmoid(scores[0]) >= 0.5) ? 1.0 : 0.0;
+	}
+	return scores[0];
+}
+
+// labelIds holds the class of every validation row (-1 for a label the model was not trained on, probability 0),
+// mapped once per fit; every probability is clamped to [1e-15, 1 - 1e-15]
+template <class Scalar>
+double BasicXGBoostModel<Scalar>::logLoss(const std::vector<double>& raw, const std::vector<int>& labelIds) const {
+	const int K = outputs();
+	double total = 0.0;
+	for (size_t i = 0; i < labelIds.size(); ++i) {
+		const int label = labelIds[i];
+		double prob;
+		if (K > 1) {
+			// softmax of the one class needed, shifted by the largest score so exp never overflows
+			const double* scores = &raw[i * K];
+			const double top = *std::max_element(scores, scores + K);
+			double sum = 0.0;
+			for (int k = 0; k < K; ++k) sum += std::exp(scores[k] - top);
+			prob = label < 0 ? 0.0 : std::exp(scores[label] - top) / sum;
+		} else {
+			const double pos = sigmoid(raw[i]);
+			prob = label == 1 ? pos : 1.0 - pos;
+		}
+		total -= std::log(std::min(1.0 - 1e-15, std::max(1e-15, prob)));
+	}
+	return labelIds.empty() ? 0.0 : total / static_cast<double>(labelIds.size());
+}
+
+template <class Scalar>
+double BasicXGBoostModel<Scalar>::predict(const std::vector<double>& input) const {
     	if (!isFitted) {
         	throw std::runtime_error("Model not fitted. Call fit() first.");
     	}
 
-    	double score = initialBias;
-    	for (const auto& tree : trees) {
-        	score += static_cast<double>(learningRate) * tree.predict(input);
+    	// the trees were trained on float32 features, so score the row the same way
+    	return predict(FeatureMatrix::fromColumnMajor(std::vector<float>(input.begin(), input.end()), 1, input.size()), 0);
+}
+
+template <class Scalar>
+double BasicXGBoostModel<Scalar>::predict(const FeatureMatrix& X, std::size_t row) const {
+    	if (!isFitted) {
+        	throw std::runtime_error("Model not fitted. Call fit() first.");
     	}
 
-        if (isClassification) { // return binary 1 or 0 depending on probability 
-            double prob = sigmoid(score);
-            return (prob >= 0.5) ? 1.0 : 0.0;
-        }
+    	if (X.cols() != static_cast<std::size_t>(nFeatures)) {
+        	throw std::invalid_argument("predict: feature dimension mismatch.");
+    	}
 
-    	return score;
+    	std::vector<float> x(X.cols());
+    	X.copyRow(row, x.data());
+    	if (!classLabels.empty()) {
+        	std::vector<double> scores(classForests.size());
+        	for (std::size_t k = 0; k < scores.size(); ++k) scores[k] = classBias[k] + classForests[k].sum(x.data());
+        	return outputOf(scores.data());
+    	}
+    	const double score = initialBias + packed.sum(x.data());
+    	return outputOf(&score);
 }
 
-void XGBoostModel::fit(const std::vector<float>& x_values, const std::vector<std::string>& columns, const std::vector<float>& y_values) {
+template <class Scalar>
+void BasicXGBoostModel<Scalar>::predict(const FeatureMatrix& X, std::size_t begin, std::size_t end, double* out) const {
+    	if (!isFitted) {
+        	throw std::runtime_error("Model not fitted. Call fit() first.");
+    	}
+
+    	if (X.cols() != static_cast<std::size_t>(nFeatures)) {
+        	throw std::invalid_argument("predict: feature dimension mismatch.");
+    	}
+
+    	if (!classLabels.empty()) {
+        	// softmax is monotone, so the most probable class is the one with the highest raw score
+        	const std::size_t K = classLabels.size();
+        	thread_local std::vector<double> proba;
+        	proba.resize((end - begin) * K);
+        	predictProba(X, begin, end, proba.data());
+        	for (std::size_t i = 0; i < end - begin; ++i) out[i] = outputOf(&proba[i * K]);
+        	return;
+    	}
+
+    	packed.sums(X, begin, end, out);
+    	for (std::size_t i = 0; i < end - begin; ++i) {
+        	const double score = initialBias + out[i];
+        	out[i] = outputOf(&score);
+    	}
+}
+
+template <class Scalar>
+void BasicXGBoostModel<Scalar>::predictProba(const FeatureMatrix& X, std::size_t begin, std::size_t end, double* out) const {
+    	if (!isFitted) {
+        	throw std::runtime_error("Model not fitted. Call fit() first.");
+    	}
+
+    	if (!isClassification) {
+        	throw std::logic_error("predictProba: the model is a regressor.");
+    	}
+
+    	if (X.cols() != static_cast<std::size_t>(nFeatures)) {
+        	throw std::invalid_argument("predict: feature dimension mismatch.");
+    	}
+
+    	const std::size_t rows = end - begin;
+    	thread_local std::vector<double> scores;
+    	scores.resize(rows);
+    	if (classLabels.empty()) { // binary: {1 - p, p}
+        	packed.sums(X, begin, end, scores.data());
+        	for (std::size_t i = 0; i < rows; ++i) {
+            	const double prob = sigmoid(initialBias + scores[i]);
+            	out[2 * i] = 1.0 - prob;
+            	out[2 * i + 1] = prob;
+        	}
+        	return;
+    	}
+
+    	// one batch traversal per class forest, scattered into rows of K scores, then normalized row by row
+    	const std::size_t K = classLabels.size();
+    	for (std::size_t k = 0; k < K; ++k) {
+        	classForests[k].sums(X, begin, end, scores.data());
+        	for (std::size_t i = 0; i < rows; ++i) out[i * K + k] = classBias[k] + scores[i];
+    	}
+    	for (std::size_t i = 0; i < rows; ++i) softmax(out + i * K, static_cast<int>(K));
+}
+
+template <class Scalar>
+std::vector<float> BasicXGBoostModel<Scalar>::predictProba(const MatrixView& X) const {
+	if (!isFitted) {
+		throw std::runtime_error("Model not fitted. Call fit() before predict().");
+    	}
+
+    	const std::size_t K = static_cast<std::size_t>(getNClasses());
+    	std::vector<float> proba(X.rows * K);
+    	const FeatureMatrix M(X);
+    	ThreadPool::shared().parallelChunks(X.rows, getPredictThreads(), 256, [&](std::size_t begin, std::size_t end) {
+        	std::vector<double> rows((end - begin) * K);
+        	predictProba(M, begin, end, rows.data()); // checks the task and the feature count
+        	std::copy(rows.begin(), rows.end(), proba.begin() + begin * K);
+    	});
+    	return proba;
+}
+
+template <class Scalar>
+void BasicXGBoostModel<Scalar>::fit(const std::vector<float>& x_values, const std::vector<std::string>& columns, const std::vector<float>& y_values) {
 	if (columns.empty()) {
         	throw std::invalid_argument("Columns must be provided for XGBoostModel::fit.");
     	}
@@ -152,26 +571,42 @@ void XGBoostModel::fit(const std::vector<float>& x_values, const std::vector<std
     	}
 
     	const size_t rowCount = x_values.size() / columnCount;
+    	fitView(MatrixView(x_values.data(), rowCount, columnCount), y_values);
+}
 
-        // Check for 1:1 mapping first
-        if (y_values.size() == rowCount) {
-             std::vector<std::vector<double>> features(rowCount, std::vector<double>(columnCount));
-    	     for (size_t i = 0; i < rowCount; ++i) {
-        	    for (size_t j = 0; j < columnCount; ++j) {
-            		features[i][j] = static_cast<double>(x_values[i * columnCount + j]);
-        	    }
-    	     }
-    	     std::vector<double> targets(y_values.begin(), y_values.end());
-    	     fit(features, targets);
-             return;
-        }
+template <class Scalar>
+void BasicXGBoostModel<Scalar>::fitView(const MatrixView& X, Span<const float> y_values) {
+    	if (X.empty() || y_values.size == 0) {
+        	throw std::invalid_argument("Feature and target vectors must be non-empty.");
+    	}
+
+    	// one-hot classification targets are decoded to the class id of their largest column, like RandomForest
+    	if (isClassification && y_values.size > X.rows && y_values.size % X.rows == 0) {
+        	const size_t n_target_cols = y_values.size / X.rows;
+        	std::vector<Scalar> targets(X.rows);
+        	for (size_t i = 0; i < X.rows; ++i) {
+            	const float* row = y_values.data + i * n_target_cols;
+            	targets[i] = static_cast<Scalar>(std::max_element(row, row + n_target_cols) - row);
+        	}
+        	fit(FeatureMatrix(X), Span<const Scalar>(targets));
+        	return;
+    	}
+
+    	if (X.rows != y_values.size) { // check for encoding mismatch 
+        	throw std::invalid_argument("Feature rows must match target size (one target per row, or one-hot rows for classification).");
+    	}
 
-    	if (rowCount != y_values.size()) { // check for encoding mismatch 
-        	throw std::invalid_argument("Feature rows must match target size (XGBoost only supports single-output regression/binary classification).");
+    	// the trees read the row-major float buffer in place, and the float32 model the targets too
+    	if constexpr (std::is_same<Scalar, float>::value) {
+    		fit(FeatureMatrix(X), y_values);
+    	} else {
+    		const std::vector<Scalar> targets(y_values.begin(), y_values.end());
+    		fit(FeatureMatrix(X), Span<const Scalar>(targets));
     	}
 }
 
-std::vector<float> XGBoostModel::predict(const std::vector<float>& x_values, const std::vector<std::string>& columns) const {
+template <class Scalar>
+std::vector<float> BasicXGBoostModel<Scalar>::predict(const std::vector<float>& x_values, const std::vector<std::string>& columns) const {
 	if (!isFitted) {
 		throw std::runtime_error("Model not fitted. Call fit() before predict().");
     	}
@@ -187,17 +622,30 @@ std::vector<float> XGBoostModel::predict(const std::vector<float>& x_values, con
     	}
 
     	const size_t rowCount = x_values.size() / columnCount;
-    	std::vector<float> predictions;
-    	predictions.reserve(rowCount);
+    	std::vector<float> predictions(rowCount);
+    	predictInto(MatrixView(x_values.data(), rowCount, columnCount), predictions);
 
-    	for (size_t i = 0; i < rowCount; ++i) {
-        	std::vector<double> sample(columnCount);
+	return predictions;
+}
 
-        	for (size_t j = 0; j < columnCount; ++j) {
-            		sample[j] = static_cast<double>(x_values[i * columnCount + j]);
-        	}
-        	predictions.push_back(static_cast<float>(predict(sample)));
+template <class Scalar>
+void BasicXGBoostModel<Scalar>::predictInto(const MatrixView& X, Span<float> out) const {
+	if (!isFitted) {
+		throw std::runtime_error("Model not fitted. Call fit() before predict().");
     	}
 
-	return predictions;
+    	if (out.size != X.rows) {
+        	throw std::invalid_argument("predictInto: output size must match the number of rows.");
+    	}
+
+    	const FeatureMatrix M(X);
+    	ThreadPool::shared().parallelChunks(X.rows, getPredictThreads(), 256, [&](std::size_t begin, std::size_t end) {
+        	thread_local std::vector<double> scores;
+        	scores.resize(end - begin);
+        	predict(M, begin, end, scores.data()); // checks the feature count
+        	for (std::size_t i = begin; i < end; ++i) out[i] = static_cast<float>(scores[i - begin]);
+    	});
 }
+
+template class BasicXGBoostModel<float>;
+template class BasicXGBoostModel<double>;
@@ -1,12 +1,20 @@
 #ifndef XGBOOSTMODEL_H
 #define XGBOOSTMODEL_H
 
+#include <algorithm>
 #include <string>
+#include <type_traits>
 #include <vector>
+#include "BenchmarkStrategy.h"
 #include "DecisionTree.h"
 #include "IModel.h"
+#include "PackedForest.h"
 
-class XGBoostModel : public IModel {
+// Scalar is the precision of targets, residuals, thresholds and leaf values, see BasicDecisionTree.
+// Classification with more than two distinct labels is multiclass: every round grows one tree per class on the
+// softmax log loss gradients, and predictions are the label of the most probable class.
+template <class Scalar>
+class BasicXGBoostModel : public IModel {
 private:
 	int nEstimators;
 	float learningRate;
@@ -14,16 +22,53 @@ private:
 	float subsampleRatio;
     	float gamma;
     	std::string regularization;
+    	float lambda = 1.0f; // strength of the "L1" / "L2" leaf weight penalty
+    	float maxDeltaStep = 0.0f; // largest leaf weight magnitude (XGBoost's max_delta_step), 0 for no limit
 
-    	std::vector<DecisionTree> trees;
+    	std::vector<BasicDecisionTree<Scalar>> trees;
+    	PackedForest packed; // trees with the learning rate folded into the leaves, built at the end of fit
     	double initialBias = 0.0;
+    	// multiclass only: sorted labels (class id -> label), per-class base scores and the trees of each class packed apart
+    	std::vector<double> classLabels;
+    	std::vector<double> classBias;
+    	std::vector<PackedForest> classForests;
+    	int nFeatures = 0;
     	bool isFitted = false;
         bool isClassification = false;
+        SplitMode splitMode = SplitMode::Exact;
+        TreeGrowth growth = TreeGrowth::DepthFirst;
+        int maxBins = FeatureBins::kMaxBins;
+        int numThreads = 0;
+
+        // early stopping, the datasets and metric are borrowed (see setValidation); no metric scores the log loss
+        const Dataset* validationFeatures = nullptr;
+        const Dataset* validationTargets = nullptr;
+        const BenchmarkStrategy* evalMetric = nullptr;
+        int earlyStoppingRounds = 0;
+        std::vector<double> validationScores;
+        int bestIteration = 0;
+
+        GradientParams gradientParams() const;
+        int outputs() const { return classLabels.empty() ? 1 : static_cast<int>(classLabels.size()); }
+        // prediction from the raw scores of one row, outputs() of them
+        double outputOf(const double* scores) const;
+        // mean log loss of validation rows from their raw scores, outputs() per row, and their class ids
+        double logLoss(const std::vector<double>& raw, const std::vector<int>& labelIds) const;
 
 public:
-	XGBoostModel(int nEstimators, float learningRate, int maxDepth, float subsampleRatio, float gamma, std::string regularization, bool isClassification = false);
+	BasicXGBoostModel(int nEstimators, float learningRate, int maxDepth, float subsampleRatio, float gamma, std::string regularization, bool isClassification = false);
 
     	double predict(const std::vector<double>& input) const;
+    	double predict(const FeatureMatrix& X, std::size_t row) const;
+    	// predictions for rows [begin, end) of X through the batch traversal, out[row - begin]
+    	void predict(const FeatureMatrix& X, std::size_t begin, std::size_t end, double* out) const;
+    	// class probabilities of rows [begin, end) of X, out[(row - begin) * getNClasses() + class id]; classification only
+    	void predictProba(const FeatureMatrix& X, std::size_t begin, std::size_t end, double* out) const;
+    	// predictProba for every row of X, split over getPredictThreads()
+    	std::vector<float> predictProba(const MatrixView& X) const;
+    	void fit(const FeatureMatrix& X, Span<const Scalar> Y);
+    	// float64 targets, converted to Scalar once
+    	void fit(const FeatureMatrix& X, const std::vector<double>& Y);
     	void fit(const std::vector<std::vector<double>>& X, const std::vector<double>& Y);
 
     	void setNEstimators(int count) { nEstimators = count; }
@@ -32,6 +77,16 @@ public:
     	void setSubsampleRatio(float ratio) { subsampleRatio = ratio; }
     	void setGamma(float gammaValue) { gamma = gammaValue; }
     	void setRegularization(const std::string& regularizationType) { regularization = regularizationType; }
+    	void setLambda(float lambdaValue) { lambda = lambdaValue; }
+    	// bounds every leaf weight to [-step, step] before the learning rate; meant for unregularized log loss, where the
+    	// hessians p(1 - p) of confident rows vanish and -G / H can jump far past the data
+    	void setMaxDeltaStep(float step) { maxDeltaStep = step; }
+    	void setSplitMode(SplitMode mode) { splitMode = mode; }
+    	void setGrowth(TreeGrowth order) { growth = order; }
+    	void setMaxBins(int bins) { maxBins = bins; }
+    	// threads for fit, <= 0 (the default, as for RandomForest) uses every hardware thread; shared by each tree's split
+    	// search and the per-round prediction update, the model does not depend on it
+    	void setNumThreads(int threads) { numThreads = threads; }
 
     	int getNEstimators() const { return nEstimators; }
     	float getLearningRate() const { return learningRate; }
@@ -39,13 +94,42 @@ public:
     	float getSubsampleRatio() const { return subsampleRatio; }
     	float getGamma() const { return gamma; }
     	std::string getRegularization() const { return regularization; }
+    	float getLambda() const { return lambda; }
+    	float getMaxDeltaStep() const { return maxDeltaStep; }
+    	SplitMode getSplitMode() const { return splitMode; }
+    	TreeGrowth getGrowth() const { return growth; }
+    	int getMaxBins() const { return maxBins; }
+    	int getNumThreads() const { return numThreads; }
+
+    	// after every round fit scores the model on xVal / yVal with metric.evaluatePredictions (lower is better) from
+    	// validation scores it updates by the new tree only. It stops once earlyStoppingRounds rounds in a row did not
+    	// improve on the best (<= 0 never stops early) and keeps the trees up to the best round. The datasets and the
+    	// metric are borrowed and must outlive the fits. ClassificationBenchmark scores 1 - accuracy, a step function that
+    	// can sit on a plateau for many rounds; classifiers can stop on the smooth log loss instead (below).
+    	void setValidation(const Dataset& xVal, const Dataset& yVal, const BenchmarkStrategy& metric, int earlyStoppingRounds = 0);
+    	// the same for classifiers, scored with the validation log loss (binary or softmax) of the raw scores
+    	void setValidation(const Dataset& xVal, const Dataset& yVal, int earlyStoppingRounds = 0);
+    	void clearValidation();
+    	// metric after every trained round, empty without a validation set
+    	const std::vector<double>& getValidationScores() const { return validationScores; }
+    	// rounds kept by the last fit
+    	int getBestIteration() const { return bestIteration; }
+
+    	// classes of the fitted classifier (2 for binary, labels 0 and 1), 0 for regression
+    	int getNClasses() const { return isClassification ? std::max(2, static_cast<int>(classLabels.size())) : 0; }
 
     	bool fitted() const { return isFitted; }
     	double bias() const { return initialBias; }
 
     	void fit(const std::vector<float>& x_values, const std::vector<std::string>& columns, const std::vector<float>& y_values) override;
     	std::vector<float> predict(const std::vector<float>& x_values, const std::vector<std::string>& columns) const override;
-    	std::string getName() const override { return "XGBoost"; }
+    	std::string getName() const override { return std::is_same<Scalar, double>::value ? "XGBoost (float64)" : "XGBoost"; }
+    	// rows split over getPredictThreads(), no heap allocation once the per-thread scratch is warm
+    	void predictInto(const MatrixView& X, Span<float> out) const override;
+    	void fitView(const MatrixView& X, Span<const float> y) override;
 };
 
+using XGBoostModel = BasicXGBoostModel<float>;
+using XGBoostModel64 = BasicXGBoostModel<double>;
+
 #endif
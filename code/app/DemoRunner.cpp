@@ -14,6 +14,7 @@
 #include "MLSuite/RegressionBenchmark.h"
 #include "MLSuite/ClassificationBenchmark.h"
 #include "MLSuite/Dataset.h"
+#include "MLSuite/RandomForestBuilder.h"
 
 namespace {
 void logLine(const DemoRunner::LogFn& log, const std::string& line) {
@@ -74,6 +75,17 @@ int DemoRunner::runFullDemo(const LogFn& log) {
             		regressionBenchmark.trainAndExecute(*model, x_train, y_train, x_test, y_test);
         	}
 
+        	{
+            		logLine(log, "--- Precision: Random Forest float32 vs float64 ---");
+            		RandomForestBuilder builder;
+            		builder.setEstimators(50).setMaxDepth(10).setMinSamplesSplit(2).setMaxFeatures(0).setBootstrap(true).setRandomState(0);
+            		auto float32Model = builder.build();
+            		auto float64Model = builder.build<double>();
+
+            		PrecisionComparison comparison = regressionBenchmark.comparePrecision(*float32Model, *float64Model, x_train, y_train, x_test, y_test);
+            		logLine(log, "float32 - float64 MSE difference: " + std::to_string(comparison.scoreDifference));
+        	}
+
         	{
             		logLine(log, "--- Benchmarking XGBoost ---");
             		// Create a different model from the same factory
@@ -95,8 +107,8 @@ int DemoRunner::runFullDemo(const LogFn& log) {
             	std::unique_ptr<IModel> bestModel = regressionFactory.randomSearch(
                 	"RandomForest",
                 	rfParams,
-                	x_train.get_data_as_double_2d(),
-                	y_train.get_data_as_double_1d(),
+                	x_train.view(),
+                	y_train.values(),
                 	regressionBenchmark, // Passing the RegressionBenchmark strategy!
                 	log
             	);
@@ -74,6 +74,7 @@ TEST(RandomForestBuilderTest, BuildWithParams) {
     
     ASSERT_NE(model, nullptr);
     EXPECT_EQ(model->getName(), "Random Forest");
+    EXPECT_EQ(model->getNumThreads(), 0); // every hardware thread, the same default as XGBoost
     // RandomForest exposes getTrees(), so we can check count after fitting.
     
     std::vector<std::vector<double>> X = {{1.0, 2.0}, {3.0, 4.0}};
@@ -82,6 +83,21 @@ TEST(RandomForestBuilderTest, BuildWithParams) {
     EXPECT_EQ(model->getTrees().size(), 20);
 }
 
+TEST(RandomForestBuilderTest, MaxFeaturesPolicies) {
+    auto sqrtModel = RandomForestBuilder().setMaxFeaturesPolicy(MaxFeaturesPolicy::Sqrt).build();
+    EXPECT_EQ(sqrtModel->featuresPerSplit(400), 20);
+
+    auto log2Model = RandomForestBuilder().setMaxFeaturesPolicy(MaxFeaturesPolicy::Log2).build();
+    EXPECT_EQ(log2Model->featuresPerSplit(400), 8);
+
+    auto fractionModel = RandomForestBuilder().setMaxFeaturesFraction(0.25).build();
+    EXPECT_EQ(fractionModel->featuresPerSplit(400), 100);
+    EXPECT_EQ(fractionModel->featuresPerSplit(2), 1);
+
+    EXPECT_THROW(RandomForestBuilder().setMaxFeaturesFraction(0.0), std::invalid_argument);
+    EXPECT_THROW(RandomForestBuilder().setMaxFeaturesFraction(1.5), std::invalid_argument);
+}
+
 // --- XGBoostBuilder Tests ---
 
 TEST(XGBoostBuilderTest, BuildWithParams) {
@@ -104,4 +120,5 @@ TEST(XGBoostBuilderTest, BuildWithParams) {
     EXPECT_FLOAT_EQ(model->getSubsampleRatio(), 0.8f);
     EXPECT_FLOAT_EQ(model->getGamma(), 0.1f);
     EXPECT_EQ(model->getRegularization(), "L1");
+    EXPECT_EQ(model->getNumThreads(), 0);
 }
@@ -0,0 +1,173 @@
+#include "gtest/gtest.h"
+#include "../code/MLSuite/Dataset.h"
+#include "../code/MLSuite/DatasetStream.h"
+#include "../code/MLSuite/FeatureMatrix.h"
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+
+class DatasetTest : public ::testing::Test {
+protected:
+    std::string csvFile = "dataset_test.csv";
+
+    void write(const std::string& contents) {
+        std::ofstream ofs(csvFile, std::ios::binary);
+        ofs << contents;
+    }
+
+    void TearDown() override {
+        std::remove(csvFile.c_str());
+    }
+};
+
+TEST_F(DatasetTest, ReadCsv_ParsesHeaderAndRowMajorValues) {
+    write("a,b,c\n1.5,-2,3e2\n0.1,+4,-0.25e-1");
+    Dataset d(csvFile, "train");
+
+    EXPECT_EQ(d.get_columns(), (std::vector<std::string>{"a", "b", "c"}));
+    EXPECT_EQ(d.get_data(), (std::vector<float>{1.5f, -2.0f, 300.0f, 0.1f, 4.0f, -0.025f}));
+}
+
+TEST_F(DatasetTest, ReadCsv_MatchesStofCellHandling) {
+    // CRLF endings, blank lines, padded cells, a trailing comma and a cell that is not a number
+    write("x,y\r\n 7,8abc\r\n\n9,x,\n1e-3,123456789.123\n");
+    Dataset d(csvFile, "train");
+
+    EXPECT_EQ(d.get_data(), (std::vector<float>{std::stof(" 7"), std::stof("8abc"), 9.0f,
+                                                std::stof("1e-3"), std::stof("123456789.123")}));
+}
+
+TEST_F(DatasetTest, ReadCsv_MissingFileThrows) {
+    Dataset d(csvFile, "train");
+    EXPECT_THROW(d.read_csv("does_not_exist.csv"), std::runtime_error);
+}
+
+TEST_F(DatasetTest, ReadCsv_ThreadCountDoesNotChangeData) {
+    // a few MB so the block is cut into several newline-aligned chunks
+    std::string contents = "a,b,c,d,e,f,g,h\n";
+    for (int i = 0; i < 60000; ++i) {
+        for (int j = 0; j < 8; ++j) {
+            contents += std::to_string((i * 31 + j * 7) % 1000 / 8.0 - 60.0);
+            contents += j == 7 ? "\n" : ",";
+        }
+    }
+    write(contents);
+
+    Dataset serial(csvFile, "train", 1);
+    Dataset parallel(csvFile, "train", 4);
+
+    EXPECT_EQ(serial.get_data().size(), 60000u * 8u);
+    EXPECT_EQ(serial.get_data(), parallel.get_data());
+}
+
+TEST_F(DatasetTest, MovedValues_ViewAndTakeDataShareOneBuffer) {
+    std::vector<float> values = {1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f};
+    const float* buffer = values.data();
+    Dataset d(std::move(values), {"a", "b"});
+
+    MatrixView view = d.view();
+    EXPECT_EQ(view.data, buffer);
+    EXPECT_EQ(view.rows, 3u);
+    EXPECT_EQ(view.cols, 2u);
+    EXPECT_EQ(view(2, 1), 6.0f);
+    EXPECT_EQ(d.values().size, 6u);
+
+    std::vector<float> taken = d.take_data();
+    EXPECT_EQ(taken.data(), buffer);
+    EXPECT_EQ(d.num_rows(), 0u);
+
+    d.set_data(std::move(taken), {"a", "b", "c"});
+    EXPECT_EQ(d.get_data().data(), buffer);
+    EXPECT_EQ(d.num_rows(), 2u);
+    EXPECT_THROW(Dataset(std::vector<float>{1.0f, 2.0f, 3.0f}, {"a", "b"}), std::invalid_argument);
+}
+
+TEST_F(DatasetTest, BinaryFormat_RoundTripsCsvThroughMappedColumns) {
+    const std::string binaryFile = "dataset_test.mlbin";
+    write("a,b,c\n1,2,3\n4,5,6\n-7.5,8,9\n");
+    Dataset::convert_csv_to_binary(csvFile, binaryFile);
+
+    Dataset csv(csvFile, "train");
+    Dataset binary(binaryFile, "train");
+    ASSERT_TRUE(binary.is_mapped());
+    EXPECT_EQ(binary.get_columns(), csv.get_columns());
+    EXPECT_EQ(binary.num_rows(), 3u);
+
+    const Span<const float> b = binary.column(1);
+    EXPECT_EQ(std::vector<float>(b.begin(), b.end()), (std::vector<float>{2.0f, 5.0f, 8.0f}));
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(b.data) % 64, 0u);
+
+    // tree models read the mapped columns in place
+    const FeatureMatrix m(binary);
+    EXPECT_EQ(m.rows(), 3u);
+    EXPECT_EQ(m.cols(), 3u);
+    EXPECT_EQ(m(2, 0), -7.5f);
+    EXPECT_EQ(m(1, 1), 5.0f);
+
+    // view() is the mapped columns in place, a row-major copy only exists after materialize()
+    const MatrixView v = binary.view();
+    EXPECT_FALSE(v.isRowMajor());
+    EXPECT_EQ(v.data, binary.column(0).data);
+    EXPECT_EQ(v.toVector(), csv.get_data());
+    EXPECT_THROW(binary.get_data(), std::logic_error);
+    EXPECT_THROW(binary.values(), std::logic_error);
+    EXPECT_THROW(csv.column(0), std::logic_error);
+
+    binary.materialize();
+    EXPECT_FALSE(binary.is_mapped());
+    EXPECT_EQ(binary.get_data(), csv.get_data());
+
+    std::remove(binaryFile.c_str());
+}
+
+TEST_F(DatasetTest, BinaryFormat_RejectsOtherFiles) {
+    const std::string binaryFile = "dataset_test.mlbin";
+    {
+        std::ofstream ofs(binaryFile, std::ios::binary);
+        ofs << "a,b\n1,2\n this is a csv with the wrong extension, padded past the header size";
+    }
+    Dataset d(binaryFile, "train");
+    EXPECT_THROW(d.read_binary(binaryFile), std::runtime_error);
+    EXPECT_FALSE(d.is_mapped());
+    std::remove(binaryFile.c_str());
+}
+
+TEST_F(DatasetTest, Stream_BatchesMatchFullLoad) {
+    const std::string binaryFile = "dataset_test.mlbin";
+    std::string contents = "a,b\n";
+    for (int i = 0; i < 10; ++i) contents += std::to_string(i) + "," + std::to_string(i * 0.5) + "\n";
+    write(contents);
+    Dataset::convert_csv_to_binary(csvFile, binaryFile);
+    const std::vector<float> expected = Dataset(csvFile, "train").get_data();
+
+    for (const std::string& path : {csvFile, binaryFile}) {
+        for (bool prefetch : {false, true}) {
+            DatasetStream stream(path, 4, prefetch);
+            EXPECT_EQ(stream.columns(), (std::vector<std::string>{"a", "b"}));
+
+            for (int pass = 0; pass < 2; ++pass) { // the second pass checks reset()
+                std::vector<float> values;
+                std::vector<std::size_t> batchSizes;
+                MatrixView batch;
+                while (stream.next(batch)) {
+                    batchSizes.push_back(batch.rows);
+                    const std::vector<float> rows = batch.toVector();
+                    values.insert(values.end(), rows.begin(), rows.end());
+                }
+                EXPECT_EQ(values, expected) << path;
+                EXPECT_EQ(batchSizes, (std::vector<std::size_t>{4, 4, 2}));
+                EXPECT_EQ(stream.rowsRead(), 10u);
+                EXPECT_FALSE(stream.next(batch));
+                stream.reset();
+            }
+        }
+    }
+    std::remove(binaryFile.c_str());
+}
+
+TEST_F(DatasetTest, Stream_RaggedCsvRowThrows) {
+    write("a,b\n1,2\n3\n");
+    DatasetStream stream(csvFile, 8);
+    MatrixView batch;
+    EXPECT_THROW(stream.next(batch), std::runtime_error);
+}
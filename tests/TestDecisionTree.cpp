@@ -1,5 +1,6 @@
 #include "gtest/gtest.h"
 #include "../code/MLSuite/DecisionTree.h"
+#include <algorithm>
 #include <vector>
 
 TEST(DecisionTreeTest, SimpleSplit) {
@@ -27,3 +28,351 @@ TEST(DecisionTreeTest, EdgeCase_SingleSample) {
     
     EXPECT_NEAR(tree.predict({1.0}), 5.0, 0.01);
 }
+
+TEST(DecisionTreeTest, ExactSplit_MatchesBruteForceImpurity) {
+    // the root split scored from running sums / class counts partitions the rows like the brute-force best split,
+    // which rebuilds both children at every candidate threshold (duplicate values included)
+    const int rows = 80, cols = 3;
+    std::vector<std::vector<double>> X;
+    std::vector<double> Y, labels;
+    for (int i = 0; i < rows; ++i) {
+        X.push_back({static_cast<double>((i * 37) % 23), static_cast<double>((i * 53) % 31), static_cast<double>((i * 11) % 7)});
+        Y.push_back(X[i][1] * 0.5 + ((i * 29) % 13) + (X[i][0] > 15 ? 6.0 : 0.0));
+        labels.push_back((i * 7 + static_cast<int>(X[i][2])) % 3 == 0 ? 1.0 : (X[i][1] > 12 ? 2.0 : 0.0));
+    }
+
+    // impurity times size: squared error around the mean, or Gini
+    auto cost = [](const std::vector<double>& values, bool classification) {
+        if (values.empty()) return 0.0;
+        const double n = static_cast<double>(values.size());
+        if (classification) {
+            double counts[3] = {0.0, 0.0, 0.0}, gini = 1.0;
+            for (double v : values) counts[static_cast<int>(v)] += 1.0;
+            for (double c : counts) gini -= (c / n) * (c / n);
+            return n * gini;
+        }
+        double mean = 0.0, sse = 0.0;
+        for (double v : values) mean += v / n;
+        for (double v : values) sse += (v - mean) * (v - mean);
+        return sse;
+    };
+
+    for (bool classification : {false, true}) {
+        const std::vector<double>& target = classification ? labels : Y;
+        int bestFeature = -1;
+        double bestThreshold = 0.0, bestCost = cost(target, classification);
+        for (int f = 0; f < cols; ++f) {
+            for (int i = 0; i < rows; ++i) {
+                std::vector<double> left, right;
+                for (int r = 0; r < rows; ++r) (X[r][f] <= X[i][f] ? left : right).push_back(target[r]);
+                const double c = cost(left, classification) + cost(right, classification);
+                if (!right.empty() && c < bestCost - 1e-9) {
+                    bestCost = c;
+                    bestFeature = f;
+                    bestThreshold = X[i][f];
+                }
+            }
+        }
+        ASSERT_NE(bestFeature, -1);
+
+        DecisionTree stump(1, 2, classification);
+        stump.fit(X, target);
+        std::vector<PackedNode> nodes;
+        stump.packInto(nodes);
+        ASSERT_FALSE(nodes[0].isLeaf());
+        EXPECT_EQ(static_cast<int>(nodes[0].feature()), bestFeature);
+        for (const auto& row : X) {
+            EXPECT_EQ(row[bestFeature] <= nodes[0].threshold, row[bestFeature] <= bestThreshold);
+        }
+    }
+}
+
+TEST(DecisionTreeTest, HistogramMode_MatchesExactOnFewDistinctValues) {
+    // with fewer distinct values than bins every boundary is a candidate, so both modes agree
+    std::vector<std::vector<double>> X = {{1.0, 5.0}, {2.0, 3.0}, {3.0, 4.0}, {4.0, 1.0}, {5.0, 2.0}, {6.0, 6.0}};
+    std::vector<double> Y = {1.0, 1.5, 1.2, 7.0, 7.5, 7.2};
+
+    DecisionTree exact(3, 2);
+    exact.fit(X, Y);
+
+    DecisionTree hist(3, 2);
+    hist.setSplitMode(SplitMode::Histogram);
+    hist.fit(X, Y);
+
+    for (const auto& row : X) {
+        EXPECT_DOUBLE_EQ(hist.predict(row), exact.predict(row));
+    }
+}
+
+TEST(DecisionTreeTest, HistogramMode_Classification) {
+    std::vector<std::vector<double>> X;
+    std::vector<double> Y;
+    for (int i = 0; i < 1000; ++i) { // more distinct values than bins
+        X.push_back({static_cast<double>(i)});
+        Y.push_back(i < 600 ? 0.0 : 2.0);
+    }
+
+    DecisionTree tree(2, 2, true);
+    tree.setSplitMode(SplitMode::Histogram);
+    tree.setMaxBins(16);
+    tree.fit(X, Y);
+
+    EXPECT_DOUBLE_EQ(tree.predict({10.0}), 0.0);
+    EXPECT_DOUBLE_EQ(tree.predict({990.0}), 2.0);
+    EXPECT_THROW(tree.setMaxBins(300), std::invalid_argument);
+}
+
+TEST(DecisionTreeTest, Classification_NonContiguousLabels) {
+    // labels are encoded to dense class ids internally and decoded back at the leaves
+    std::vector<std::vector<double>> X = {{1.0}, {2.0}, {3.0}, {10.0}, {11.0}, {12.0}, {20.0}, {21.0}};
+    std::vector<double> Y = {7.0, 7.0, 7.0, -3.0, -3.0, -3.0, 42.0, 42.0};
+
+    DecisionTree tree(4, 2, true);
+    tree.fit(X, Y);
+
+    EXPECT_DOUBLE_EQ(tree.predict({2.0}), 7.0);
+    EXPECT_DOUBLE_EQ(tree.predict({11.0}), -3.0);
+    EXPECT_DOUBLE_EQ(tree.predict({20.5}), 42.0);
+}
+
+TEST(DecisionTreeTest, PresortedMode_MatchesExact) {
+    std::vector<std::vector<double>> X;
+    std::vector<double> Y;
+    for (int i = 0; i < 200; ++i) {
+        double a = (i * 37) % 101, b = (i * 13) % 17; // repeated values exercise the tie ordering
+        X.push_back({a, b});
+        Y.push_back(a * 0.5 + (b > 8 ? 10.0 : 0.0));
+    }
+
+    DecisionTree exact(20, 2);
+    exact.fit(X, Y);
+
+    DecisionTree presorted(20, 2);
+    presorted.setSplitMode(SplitMode::Presorted);
+    presorted.fit(X, Y);
+
+    EXPECT_EQ(presorted.getNNodes(), exact.getNNodes());
+    for (const auto& row : X) {
+        EXPECT_DOUBLE_EQ(presorted.predict(row), exact.predict(row));
+    }
+}
+
+TEST(DecisionTreeTest, FeatureMatrix_RowMajorViewMatchesColumnMajorCopy) {
+    std::vector<std::vector<double>> X = {{1.0, 8.0}, {2.0, 6.0}, {3.0, 7.0}, {4.0, 1.0}, {5.0, 2.0}, {6.0, 3.0}};
+    std::vector<double> Y = {1.0, 1.0, 2.0, 5.0, 5.0, 6.0};
+
+    // non-owning view over a flat row-major buffer, as Dataset::get_data() stores it
+    std::vector<float> flat;
+    for (const auto& row : X) flat.insert(flat.end(), row.begin(), row.end());
+    FeatureMatrix view(flat, 2);
+    ASSERT_EQ(view.rows(), 6u);
+    EXPECT_FLOAT_EQ(view(3, 1), 1.0f);
+
+    FeatureMatrix owned(X);
+    EXPECT_TRUE(owned.isColumnMajor());
+    EXPECT_FALSE(view.isColumnMajor());
+
+    DecisionTree a(4, 2), b(4, 2);
+    a.fit(view, Y);
+    b.fit(owned, Y);
+    for (std::size_t i = 0; i < X.size(); ++i) {
+        EXPECT_DOUBLE_EQ(a.predict(view, i), b.predict(X[i]));
+    }
+}
+
+TEST(DecisionTreeTest, SampleCounts_MatchDuplicatedRows) {
+    std::vector<std::vector<double>> X, Xdup;
+    std::vector<double> Y, Ydup;
+    std::vector<int> counts;
+    for (int i = 0; i < 120; ++i) {
+        double a = (i * 37) % 101, b = (i * 13) % 17;
+        X.push_back({a, b});
+        Y.push_back(static_cast<int>(a) / 10 + (b > 8 ? 5.0 : 0.0));
+        counts.push_back(i % 3); // rows drawn 0, 1 or 2 times
+        for (int c = 0; c < counts.back(); ++c) {
+            Xdup.push_back(X.back());
+            Ydup.push_back(Y.back());
+        }
+    }
+
+    for (SplitMode mode : {SplitMode::Exact, SplitMode::Presorted}) {
+        DecisionTree copied(8, 4);
+        copied.setSplitMode(mode);
+        copied.fit(Xdup, Ydup);
+
+        DecisionTree weighted(8, 4);
+        weighted.setSplitMode(mode);
+        weighted.fit(FeatureMatrix(X), Y, counts);
+
+        EXPECT_EQ(weighted.getNNodes(), copied.getNNodes());
+        for (const auto& row : X) {
+            EXPECT_DOUBLE_EQ(weighted.predict(row), copied.predict(row));
+        }
+    }
+}
+
+TEST(DecisionTreeTest, FeatureSampler_RestrictsSplitFeatures) {
+    // y depends only on feature 0, but the sampler only ever offers feature 1
+    std::vector<std::vector<double>> X;
+    std::vector<double> Y;
+    for (int i = 0; i < 50; ++i) {
+        X.push_back({static_cast<double>(i), static_cast<double>(i % 5)});
+        Y.push_back(i < 25 ? 0.0 : 10.0);
+    }
+
+    int calls = 0;
+    DecisionTree tree(5, 2);
+    tree.setFeatureSampler([&calls](int, std::vector<int>& features) {
+        ++calls;
+        features.assign(1, 1);
+    });
+    tree.fit(X, Y);
+
+    EXPECT_GT(calls, 0);
+    // every split is on feature 1, so changing feature 0 never changes the prediction
+    for (const auto& row : X) {
+        EXPECT_DOUBLE_EQ(tree.predict({row[0] + 100.0, row[1]}), tree.predict(row));
+    }
+}
+
+TEST(DecisionTreeTest, NumThreads_GrowsTheSameTree) {
+    // large enough for the parallel feature search and for concurrent sibling subtrees near the root
+    std::vector<float> flat;
+    std::vector<double> Y, labels;
+    const int rows = 6000, cols = 8;
+    for (int i = 0; i < rows; ++i) {
+        for (int f = 0; f < cols; ++f) flat.push_back(static_cast<float>((i * (7 + 6 * f)) % (97 + f)));
+        Y.push_back(flat[i * cols] * 0.3 + (flat[i * cols + 3] > 50 ? 8.0 : 0.0) + (i % 7) * 0.1);
+        labels.push_back((flat[i * cols + 1] > 40) + (flat[i * cols + 5] > 60));
+    }
+    const FeatureMatrix X(flat, cols);
+
+    for (bool classification : {false, true}) {
+        for (SplitMode mode : {SplitMode::Exact, SplitMode::Presorted, SplitMode::Histogram}) {
+            DecisionTree serial(10, 2, classification), parallel(10, 2, classification);
+            serial.setSplitMode(mode);
+            parallel.setSplitMode(mode);
+            parallel.setNumThreads(4);
+            serial.fit(X, classification ? labels : Y);
+            parallel.fit(X, classification ? labels : Y);
+
+            EXPECT_EQ(parallel.getNNodes(), serial.getNNodes());
+            std::vector<PackedNode> a, b;
+            serial.packInto(a);
+            parallel.packInto(b);
+            ASSERT_EQ(a.size(), b.size());
+            for (int i = 0; i < rows; ++i) {
+                EXPECT_EQ(parallel.predict(X, i), serial.predict(X, i));
+            }
+        }
+    }
+}
+
+TEST(DecisionTreeTest, LevelWiseGrowth_MatchesDepthFirst) {
+    std::vector<float> flat;
+    std::vector<double> Y, labels;
+    std::vector<int> counts;
+    const int rows = 1500, cols = 5;
+    for (int i = 0; i < rows; ++i) {
+        for (int f = 0; f < cols; ++f) flat.push_back(static_cast<float>((i * (11 + 4 * f)) % (53 + 3 * f)));
+        Y.push_back(flat[i * cols] * 0.7 - (flat[i * cols + 2] > 30 ? 4.0 : 0.0) + (i % 5) * 0.3);
+        labels.push_back((flat[i * cols + 1] > 20) + 2 * (flat[i * cols + 4] > 40));
+        counts.push_back(i % 3);
+    }
+    const FeatureMatrix X(flat, cols);
+
+    for (bool classification : {false, true}) {
+        for (SplitMode mode : {SplitMode::Exact, SplitMode::Presorted, SplitMode::Histogram}) {
+            DecisionTree depthFirst(8, 3, classification), levelWise(8, 3, classification);
+            depthFirst.setSplitMode(mode);
+            levelWise.setSplitMode(mode);
+            levelWise.setGrowth(TreeGrowth::LevelWise);
+            depthFirst.fit(X, classification ? labels : Y, counts);
+            levelWise.fit(X, classification ? labels : Y, counts);
+
+            // node ids differ (level order), the packed breadth-first layout does not
+            std::vector<PackedNode> a, b;
+            depthFirst.packInto(a);
+            levelWise.packInto(b);
+            ASSERT_EQ(a.size(), b.size());
+            for (std::size_t k = 0; k < a.size(); ++k) {
+                ASSERT_EQ(a[k].featureAndFlag, b[k].featureAndFlag);
+                ASSERT_EQ(a[k].left, b[k].left);
+                if (a[k].isLeaf()) EXPECT_EQ(a[k].value, b[k].value);
+                else EXPECT_EQ(a[k].threshold, b[k].threshold);
+            }
+        }
+    }
+}
+
+TEST(DecisionTreeTest, LevelWiseGrowth_WideFrontierMatchesDepthFirst) {
+    // 256 bins per feature: a depth 12 regression tree or a 40-class tree has more open nodes than one histogram
+    // pass holds, so the level-wise search splits the frontier into several passes
+    std::vector<float> flat;
+    std::vector<double> Y, labels;
+    const int rows = 6000, cols = 3;
+    for (int i = 0; i < rows; ++i) {
+        for (int f = 0; f < cols; ++f) flat.push_back(static_cast<float>((i * (97 + 36 * f)) % (1009 + 4 * f)));
+        Y.push_back(flat[i * cols] * 0.01 + ((i * 7919) % 211) * 0.1);
+        labels.push_back((i * 31 + static_cast<int>(flat[i * cols + 1]) / 50) % 40);
+    }
+    const FeatureMatrix X(flat, cols);
+
+    for (bool classification : {false, true}) {
+        const int depth = classification ? 9 : 12;
+        DecisionTree depthFirst(depth, 2, classification), levelWise(depth, 2, classification);
+        depthFirst.setSplitMode(SplitMode::Histogram);
+        levelWise.setSplitMode(SplitMode::Histogram);
+        levelWise.setGrowth(TreeGrowth::LevelWise);
+        depthFirst.fit(X, classification ? labels : Y);
+        levelWise.fit(X, classification ? labels : Y);
+
+        std::vector<PackedNode> a, b;
+        depthFirst.packInto(a);
+        levelWise.packInto(b);
+        // widest level, in nodes, against the nodes one pass holds (1 << 16 cells over 256 bins, times 40 classes)
+        std::vector<int> level(a.size(), 0), width(depth + 1, 0);
+        for (std::size_t k = 0; k < a.size(); ++k) {
+            ++width[level[k]];
+            if (!a[k].isLeaf()) level[a[k].left] = level[a[k].left + 1] = level[k] + 1;
+        }
+        EXPECT_GT(*std::max_element(width.begin(), width.end()), classification ? 6 : 256);
+        ASSERT_EQ(a.size(), b.size());
+        for (std::size_t k = 0; k < a.size(); ++k) {
+            ASSERT_EQ(a[k].featureAndFlag, b[k].featureAndFlag);
+            ASSERT_EQ(a[k].left, b[k].left);
+            if (a[k].isLeaf()) EXPECT_EQ(a[k].value, b[k].value);
+            else EXPECT_EQ(a[k].threshold, b[k].threshold);
+        }
+    }
+}
+
+TEST(DecisionTreeTest, LeafValueOutput_MatchesPredictForSampledRows) {
+    std::vector<float> flat;
+    std::vector<double> Y;
+    std::vector<int> counts;
+    const int rows = 600, cols = 3;
+    for (int i = 0; i < rows; ++i) {
+        for (int f = 0; f < cols; ++f) flat.push_back(static_cast<float>((i * (5 + 8 * f)) % (41 + f)));
+        Y.push_back(flat[i * cols] - 2.0 * flat[i * cols + 1] + (i % 4));
+        counts.push_back(i % 4 == 0 ? 0 : 1);
+    }
+    const FeatureMatrix X(flat, cols);
+
+    for (TreeGrowth growth : {TreeGrowth::DepthFirst, TreeGrowth::LevelWise}) {
+        DecisionTree tree(6, 2);
+        tree.setGrowth(growth);
+        std::vector<float> leafValues(rows, -1000.0f);
+        tree.setLeafValueOutput(Span<float>(leafValues));
+        tree.fit(X, Y, counts);
+        for (int i = 0; i < rows; ++i) {
+            if (counts[i] == 0) EXPECT_EQ(leafValues[i], -1000.0f);
+            else EXPECT_EQ(leafValues[i], tree.predict(X, i));
+        }
+    }
+
+    DecisionTree tree(6, 2);
+    std::vector<float> tooShort(rows - 1);
+    tree.setLeafValueOutput(Span<float>(tooShort));
+    EXPECT_THROW(tree.fit(X, Y), std::invalid_argument);
+}
@@ -67,3 +67,26 @@ TEST_F(LinRegModelTest, EdgeCase_EmptyData) {
     
     // Expect an exception for empty data.
 }
+
+TEST_F(LinRegModelTest, ParallelPredict_MatchesSingleThread) {
+    const std::vector<std::string> columns = {"a", "b"};
+    std::vector<float> x, y;
+    for (int i = 0; i < 20000; ++i) {
+        float a = static_cast<float>(i % 97), b = static_cast<float>(i % 13);
+        x.push_back(a);
+        x.push_back(b);
+        y.push_back(2.0f * a - 3.0f * b + 1.0f);
+    }
+
+    LinRegModel model;
+    model.fit(x, columns, y);
+
+    model.setPredictThreads(1);
+    std::vector<float> serial = model.predict(x, columns);
+    model.setPredictThreads(4);
+    std::vector<float> parallel = model.predict(x, columns);
+
+    ASSERT_EQ(parallel.size(), serial.size());
+    EXPECT_EQ(parallel, serial);
+    EXPECT_EQ(model.getPredictThreads(), 4);
+}
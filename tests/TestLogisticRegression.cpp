@@ -57,3 +57,30 @@ protected:
 
 
 
+
+TEST_F(LogisticRegressionTest, StreamFit_OneBatchMatchesFullBatchDescent) {
+    Dataset x(trainFileX, "train");
+    Dataset y(trainFileY, "train");
+    LogRegModel full;
+    full.fit(x.get_data(), x.get_columns(), y.get_data(), "L2", 0.1, 0.5, 40);
+
+    // a batch holding every row makes each epoch one full-batch gradient step
+    DatasetStream xStream(trainFileX, 64);
+    DatasetStream yStream(trainFileY, 64);
+    LogRegModel streamed;
+    streamed.fit(xStream, yStream, "L2", 0.1, 0.5, 40);
+
+    const Eigen::VectorXf a = full.get_theta();
+    const Eigen::VectorXf b = streamed.get_theta();
+    ASSERT_EQ(a.size(), b.size());
+    for (Eigen::Index i = 0; i < a.size(); ++i) {
+        EXPECT_NEAR(a(i), b(i), 1e-4);
+    }
+
+    // several batches per epoch still learn a separating boundary for the training rows
+    DatasetStream xSmall(trainFileX, 2);
+    DatasetStream ySmall(trainFileY, 2);
+    LogRegModel minibatch;
+    minibatch.fit(xSmall, ySmall, "None", 0.0, 0.5, 500);
+    EXPECT_EQ(minibatch.predict(x.get_data(), x.get_columns()), y.get_data());
+}
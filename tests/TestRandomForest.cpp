@@ -1,5 +1,7 @@
 #include "gtest/gtest.h"
 #include "../code/MLSuite/RandomForest.h"
+#include "../code/MLSuite/PackedForest.h"
+#include <cmath>
 
 class RandomForestTest : public ::testing::Test {
 protected:
@@ -32,3 +34,148 @@ TEST_F(RandomForestTest, FeatureCheck) {
     EXPECT_FALSE(rf.getTrees().empty());
     EXPECT_EQ(rf.getTrees().size(), 10);
 }
+
+TEST_F(RandomForestTest, ParallelFit_SameForestForAnyThreadCount) {
+    std::vector<std::vector<double>> X;
+    std::vector<double> Y;
+    for (int i = 0; i < 200; ++i) {
+        double a = (i * 37 % 101) / 10.0;
+        double b = (i * 53 % 89) / 10.0;
+        X.push_back({a, b});
+        Y.push_back(3.0 * a - b + (i % 7) * 0.1);
+    }
+
+    RandomForest serial(12, 5, 2, 1, true, 7);
+    serial.setNumThreads(1);
+    serial.fit(X, Y);
+
+    RandomForest parallel(12, 5, 2, 1, true, 7);
+    parallel.setNumThreads(4);
+    parallel.fit(X, Y);
+
+    for (const auto& row : X) {
+        EXPECT_EQ(serial.predict(row), parallel.predict(row));
+    }
+}
+
+TEST_F(RandomForestTest, PackedTrees_MatchDecisionTreePredict) {
+    // adjacent float values whose midpoint is not a float, so the packed threshold has to be rounded down
+    const float base = std::nextafter(1.0f, 2.0f); // odd mantissa, so the midpoint rounds to nearest-even = next
+    const float next = std::nextafter(base, 2.0f);
+    std::vector<std::vector<double>> X = {{base}, {base}, {next}, {next}, {0.5}, {1.5}};
+    std::vector<double> Y = {0.0, 0.0, 1.0, 1.0, 0.0, 1.0};
+
+    RandomForest rf(1, 4, 2, 1, false, 0);
+    rf.fit(X, Y);
+
+    const DecisionTree tree = rf.getTrees()[0];
+    for (const auto& row : X) {
+        EXPECT_DOUBLE_EQ(rf.predict(row), tree.predict(row));
+    }
+    EXPECT_DOUBLE_EQ(rf.predict({base}), 0.0);
+    EXPECT_DOUBLE_EQ(rf.predict({next}), 1.0);
+}
+
+TEST_F(RandomForestTest, BatchPredict_MatchesRowByRow) {
+    std::vector<std::vector<double>> X;
+    std::vector<double> Yreg, Ycls;
+    for (int i = 0; i < 150; ++i) { // not a multiple of the 16-row groups
+        double a = (i * 37 % 101) / 10.0;
+        double b = (i * 53 % 89) / 10.0;
+        X.push_back({a, b, a - b});
+        Yreg.push_back(3.0 * a - b);
+        Ycls.push_back(a > b ? 1.0 : 0.0);
+    }
+    const FeatureMatrix M(X);
+
+    for (bool classification : {false, true}) {
+        RandomForest rf(15, 6, 2, 2, true, 3, classification);
+        rf.fit(M, classification ? Ycls : Yreg);
+
+        std::vector<double> batch(X.size());
+        rf.predict(M, 0, X.size(), batch.data());
+        for (std::size_t i = 0; i < X.size(); ++i) {
+            EXPECT_EQ(batch[i], rf.predict(M, i));
+        }
+    }
+}
+
+TEST_F(RandomForestTest, PackedSumsAt_MatchesContiguousSums) {
+    std::vector<std::vector<double>> X;
+    std::vector<double> Y;
+    for (int i = 0; i < 300; ++i) {
+        double a = (i * 37 % 101) / 10.0;
+        double b = (i * 53 % 89) / 10.0;
+        X.push_back({a, b});
+        Y.push_back(a * b);
+    }
+    const FeatureMatrix M(X);
+    RandomForest rf(5, 5, 2, 2, true, 7);
+    rf.fit(M, Y);
+
+    PackedForest packed;
+    for (const auto& tree : rf.getTrees()) packed.addTree(tree, 0.5);
+    std::vector<double> all(X.size());
+    packed.sums(M, 0, X.size(), all.data());
+
+    // every third row backwards plus a repeat: out of order, spread over several blocks, not a multiple of 16 rows
+    std::vector<int> rows;
+    for (int i = 298; i >= 0; i -= 3) rows.push_back(i);
+    rows.push_back(298);
+    std::vector<double> picked(rows.size());
+    packed.sumsAt(M, rows.data(), rows.size(), picked.data());
+    for (std::size_t k = 0; k < rows.size(); ++k) {
+        EXPECT_EQ(picked[k], all[static_cast<std::size_t>(rows[k])]);
+    }
+}
+
+TEST_F(RandomForestTest, PredictInto_StridedViewMatchesVectorPredict) {
+    // 3 features used out of a 4-wide row-major buffer (last column is padding)
+    const std::size_t rows = 40, cols = 3, stride = 4;
+    std::vector<float> buffer(rows * stride, -1.0f), packedRows, y;
+    for (std::size_t i = 0; i < rows; ++i) {
+        for (std::size_t j = 0; j < cols; ++j) {
+            buffer[i * stride + j] = static_cast<float>((i * (j + 3)) % 11);
+            packedRows.push_back(buffer[i * stride + j]);
+        }
+        y.push_back(static_cast<float>(i % 11));
+    }
+    const MatrixView view(buffer.data(), rows, cols, stride);
+    const std::vector<std::string> columns = {"a", "b", "c"};
+
+    RandomForest rf(8, 5, 2, 0, true, 11);
+    rf.fitView(view, y);
+
+    std::vector<float> out(rows);
+    rf.predictInto(view, out);
+    EXPECT_EQ(out, rf.predict(packedRows, columns));
+
+    std::vector<float> tooShort(rows - 1);
+    EXPECT_THROW(rf.predictInto(view, tooShort), std::invalid_argument);
+}
+
+TEST_F(RandomForestTest, Float64Build_GrowsTheSameTrees) {
+    // float32 features either way, so both precisions see the same split candidates
+    std::vector<std::vector<double>> X;
+    std::vector<double> Y;
+    for (int i = 0; i < 120; ++i) {
+        double a = (i * 37 % 101) / 8.0;
+        double b = (i * 53 % 89) / 4.0;
+        X.push_back({a, b});
+        Y.push_back(2.0 * a - b + (i % 5) * 0.25);
+    }
+
+    RandomForest single(6, 6, 2, 1, true, 5);
+    RandomForest64 dual(6, 6, 2, 1, true, 5);
+    single.fit(X, Y);
+    dual.fit(X, Y);
+
+    EXPECT_EQ(single.getName(), "Random Forest");
+    EXPECT_EQ(dual.getName(), "Random Forest (float64)");
+    for (std::size_t t = 0; t < single.getTrees().size(); ++t) {
+        EXPECT_EQ(single.getTrees()[t].getNNodes(), dual.getTrees()[t].getNNodes());
+    }
+    for (const auto& row : X) {
+        EXPECT_NEAR(single.predict(row), dual.predict(row), 1e-4);
+    }
+}
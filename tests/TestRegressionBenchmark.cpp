@@ -3,6 +3,7 @@
 #include "MockModel.h"
 #include "../code/MLSuite/RegressionBenchmark.h"
 #include "../code/MLSuite/Dataset.h"
+#include "../code/MLSuite/RandomForest.h"
 #include <fstream>
 #include <cstdio>
 
@@ -91,4 +92,60 @@ TEST_F(RegressionBenchmarkTest, ErrorCase_EmptyPrediction) {
         .WillRepeatedly(Return("MockModel"));
 
     benchmark.execute(mockModel, xData, yData);
-}
\ No newline at end of file
+}
+
+TEST_F(RegressionBenchmarkTest, TrainAndExecute_ReadsMappedBinaryInPlace) {
+    const std::string binaryFile = "dummy.mlbin";
+    Dataset::convert_csv_to_binary(dummyFile, binaryFile);
+    RegressionBenchmark benchmark;
+    {
+        Dataset csv(dummyFile, "train");
+        Dataset binary(binaryFile, "train");
+        ASSERT_TRUE(binary.is_mapped());
+
+        RandomForest fromCsv(3, 2, 2, 1, false, 0), fromBinary(3, 2, 2, 1, false, 0);
+        const BenchmarkResult expected = benchmark.trainAndExecute(fromCsv, csv, csv, csv, csv);
+        const BenchmarkResult result = benchmark.trainAndExecute(fromBinary, binary, binary, binary, binary);
+
+        EXPECT_TRUE(binary.is_mapped()); // fit and predict read the mapped columns through view(), get_data() would throw
+        EXPECT_EQ(result.numSamples, 2u);
+        EXPECT_DOUBLE_EQ(result.mse, expected.mse);
+    }
+    std::remove(binaryFile.c_str());
+}
+
+TEST_F(RegressionBenchmarkTest, ExecuteStream_ScoresEveryBatch) {
+    MockModel mockModel;
+    RegressionBenchmark benchmark;
+
+    // one-row batches, the mock predicts the feature itself so every prediction matches the target
+    EXPECT_CALL(mockModel, predict(_, _))
+        .Times(2)
+        .WillRepeatedly([](const std::vector<float>& x, const std::vector<std::string>&) { return x; });
+    EXPECT_CALL(mockModel, getName())
+        .Times(AtLeast(1))
+        .WillRepeatedly(Return("MockModel"));
+
+    DatasetStream xStream(dummyFile, 1);
+    DatasetStream yStream(dummyFile, 1);
+    BenchmarkResult result = benchmark.executeStream(mockModel, xStream, yStream);
+
+    EXPECT_EQ(result.numSamples, 2u);
+    EXPECT_DOUBLE_EQ(result.mse, 0.0);
+    EXPECT_DOUBLE_EQ(result.r2, 1.0);
+}
+
+TEST_F(RegressionBenchmarkTest, ComparePrecision_ScoresBothBuilds) {
+    RegressionBenchmark benchmark;
+    Dataset xData(dummyFile, "train");
+    Dataset yData(dummyFile, "train");
+
+    RandomForest float32Model(3, 2, 2, 1, false, 0);
+    RandomForest64 float64Model(3, 2, 2, 1, false, 0);
+    PrecisionComparison comparison = benchmark.comparePrecision(float32Model, float64Model, xData, yData, xData, yData);
+
+    EXPECT_EQ(comparison.float32.modelName, "Random Forest");
+    EXPECT_EQ(comparison.float64.modelName, "Random Forest (float64)");
+    EXPECT_EQ(comparison.float32.numSamples, 2u);
+    EXPECT_DOUBLE_EQ(comparison.scoreDifference, 0.0); // the values are exact in float32
+}
@@ -1,6 +1,9 @@
 #include "gtest/gtest.h"
 #include "../code/MLSuite/XGBoostModel.h"
 #include "../code/MLSuite/XGBoostBuilder.h"
+#include "../code/MLSuite/RegressionBenchmark.h"
+#include <algorithm>
+#include <cmath>
 #include <vector>
 #include <string>
 
@@ -68,3 +71,197 @@ TEST_F(XGBoostModelTest, FitAndPredict_Linear) {
     EXPECT_NEAR(pred1, 2.0, 0.5);
     EXPECT_NEAR(pred2, 4.0, 0.5);
 }
+
+TEST_F(XGBoostModelTest, LeafWeights_FollowRegularization) {
+    // one stump, learning rate 1: bias 5, residuals -5 -5 5 5, so each leaf holds G = -/+10 over H = 2 rows
+    std::vector<std::vector<double>> X = {{0.0}, {1.0}, {2.0}, {3.0}};
+    std::vector<double> Y = {0.0, 0.0, 10.0, 10.0};
+
+    auto stump = [&](const std::string& regularization, float lambda, float gamma, float maxDeltaStep = 0.0f) {
+        auto xgb = XGBoostBuilder().setNEstimators(1).setLearningRate(1.0f).setMaxDepth(1)
+            .setRegularization(regularization).setLambda(lambda).setGamma(gamma).setMaxDeltaStep(maxDeltaStep).build();
+        xgb->fit(X, Y);
+        return xgb->predict({3.0});
+    };
+
+    EXPECT_NEAR(stump("None", 1.0f, 0.0f), 10.0, 1e-5);
+    EXPECT_NEAR(stump("L2", 1.0f, 0.0f), 5.0 + 10.0 / 3.0, 1e-5);  // -G / (H + lambda)
+    EXPECT_NEAR(stump("L1", 1.0f, 0.0f), 5.0 + 9.0 / 2.0, 1e-5);   // -(G - alpha) / H
+    EXPECT_NEAR(stump("None", 0.0f, 60.0f), 5.0, 1e-5);            // gain 0.5 * (50 + 50) < gamma, no split
+    EXPECT_NEAR(stump("None", 1.0f, 0.0f, 2.0f), 7.0, 1e-5);       // -G / H = 5 clamped to maxDeltaStep
+    EXPECT_THROW(stump("Lasso", 1.0f, 0.0f), std::invalid_argument);
+}
+
+TEST_F(XGBoostModelTest, Classification_UnregularizedLeavesStayBounded) {
+    // 4% positives: every row starts near-saturated at log-odds log(0.04 / 0.96) = -3.18, so the positive leaf holds
+    // G = -38.4 over H = 1.536 and its unregularized Newton step -G / H = 25 overshoots the data
+    std::vector<std::vector<double>> X;
+    std::vector<double> Y;
+    for (int i = 0; i < 1000; ++i) {
+        X.push_back({static_cast<double>(i)});
+        Y.push_back(i >= 960 ? 1.0 : 0.0);
+    }
+
+    auto firstRound = [&](float maxDeltaStep) {
+        auto xgb = XGBoostBuilder().setNEstimators(1).setLearningRate(0.2f).setMaxDepth(1)
+            .setRegularization("None").setMaxDeltaStep(maxDeltaStep).setIsClassification(true).build();
+        xgb->fit(X, Y);
+        return xgb->predict({990.0});
+    };
+
+    EXPECT_EQ(firstRound(0.0f), 1.0); // no limit by default: 0.2 * 25 flips the positives in one round
+    EXPECT_EQ(firstRound(5.0f), 0.0); // 0.2 * 5 leaves them below p = 0.5
+    EXPECT_THROW(XGBoostBuilder().setMaxDeltaStep(-1.0f), std::invalid_argument);
+}
+
+TEST_F(XGBoostModelTest, Classification_LogLossNewtonSteps) {
+    std::vector<std::vector<double>> X;
+    std::vector<double> Y;
+    for (int i = 0; i < 200; ++i) {
+        double a = (i * 37) % 101 / 10.0, b = (i * 13) % 17;
+        X.push_back({a, b});
+        Y.push_back((a > 5.0) != (b > 8.0) ? 1.0 : 0.0);
+    }
+
+    auto xgb = XGBoostBuilder().setNEstimators(5).setLearningRate(0.5f).setMaxDepth(3).setIsClassification(true).build();
+    xgb->fit(X, Y);
+    int correct = 0;
+    for (std::size_t i = 0; i < X.size(); ++i) correct += xgb->predict(X[i]) == Y[i];
+    EXPECT_EQ(correct, static_cast<int>(X.size()));
+}
+
+TEST_F(XGBoostModelTest, EarlyStopping_KeepsTheBestValidationRound) {
+    // noisy target and deep trees: the validation MSE bottoms out long before 200 rounds
+    auto makeData = [](int rows, int seed, std::vector<float>& x, std::vector<float>& y) {
+        for (int i = 0; i < rows; ++i) {
+            const float a = static_cast<float>((i * 37 + seed) % 101), b = static_cast<float>((i * 13 + seed) % 17);
+            x.push_back(a);
+            x.push_back(b);
+            y.push_back(0.1f * a + ((i * 7919 + seed) % 23) - 11.0f);
+        }
+    };
+    std::vector<float> trainX, trainY, valX, valY;
+    makeData(300, 0, trainX, trainY);
+    makeData(100, 5, valX, valY);
+    const Dataset xVal(valX, {"a", "b"}), yVal(valY, {"target"});
+    const RegressionBenchmark metric;
+
+    auto xgb = XGBoostBuilder().setNEstimators(200).setLearningRate(0.5f).setMaxDepth(6)
+        .setValidation(xVal, yVal).setEvalMetric(metric).setEarlyStoppingRounds(10).build();
+    xgb->fit(trainX, {"a", "b"}, trainY);
+
+    const auto& scores = xgb->getValidationScores();
+    const int best = xgb->getBestIteration();
+    ASSERT_LT(scores.size(), 200u);
+    EXPECT_EQ(static_cast<int>(scores.size()), best + 10);
+    EXPECT_EQ(std::min_element(scores.begin(), scores.end()) - scores.begin(), best - 1);
+    // the truncated model scores what the incremental validation scores said at its best round
+    EXPECT_NEAR(metric.evaluate(*xgb, xVal, yVal), scores[best - 1], 1e-3 * scores[best - 1]);
+
+    EXPECT_THROW(XGBoostBuilder().setValidation(xVal, yVal).build(), std::invalid_argument);
+}
+
+TEST_F(XGBoostModelTest, EarlyStopping_OnValidationLogLoss) {
+    // a noisy threshold: the log loss keeps moving after accuracy has settled, and bottoms out once the trees fit noise
+    auto makeData = [](int rows, int seed, std::vector<float>& x, std::vector<float>& y) {
+        for (int i = 0; i < rows; ++i) {
+            const float a = static_cast<float>((i * 37 + seed) % 101), b = static_cast<float>((i * 13 + seed) % 17);
+            x.push_back(a);
+            x.push_back(b);
+            y.push_back((a > 50.0f) != ((i * 7919 + seed) % 5 == 0) ? 1.0f : 0.0f); // 20% flipped labels
+        }
+    };
+    std::vector<float> trainX, trainY, valX, valY;
+    makeData(300, 0, trainX, trainY);
+    makeData(100, 5, valX, valY);
+    const Dataset xVal(valX, {"a", "b"}), yVal(valY, {"target"});
+
+    auto xgb = XGBoostBuilder().setNEstimators(200).setLearningRate(0.5f).setMaxDepth(6).setIsClassification(true)
+        .setValidation(xVal, yVal).setEvalLogLoss().setEarlyStoppingRounds(10).build();
+    xgb->fit(trainX, {"a", "b"}, trainY);
+
+    const auto& scores = xgb->getValidationScores();
+    const int best = xgb->getBestIteration();
+    ASSERT_LT(scores.size(), 200u);
+    EXPECT_EQ(static_cast<int>(scores.size()), best + 10);
+    EXPECT_EQ(std::min_element(scores.begin(), scores.end()) - scores.begin(), best - 1);
+    EXPECT_LT(scores[best - 1], std::log(2.0)); // better than p = 0.5 everywhere
+
+    // the kept rounds score the same log loss from the packed model's probabilities
+    const std::vector<float> proba = xgb->predictProba(MatrixView(valX.data(), 100, 2));
+    double loss = 0.0;
+    for (std::size_t i = 0; i < 100; ++i) loss -= std::log(proba[i * 2 + (valY[i] > 0.5f ? 1 : 0)]);
+    EXPECT_NEAR(loss / 100.0, scores[best - 1], 1e-4);
+
+    XGBoostModel regressor(10, 0.5f, 3, 1.0f, 0.0f, "L2");
+    EXPECT_THROW(regressor.setValidation(xVal, yVal), std::invalid_argument);
+}
+
+TEST_F(XGBoostModelTest, Multiclass_SoftmaxPredictsLabelsAndProbabilities) {
+    // three bands of a, labelled 1, 4 and 7
+    std::vector<float> x, y, oneHot;
+    const float labels[] = {1.0f, 4.0f, 7.0f};
+    for (int i = 0; i < 150; ++i) {
+        const float a = static_cast<float>((i * 37) % 101), b = static_cast<float>((i * 13) % 17);
+        const int c = a < 33.0f ? 0 : (a < 66.0f ? 1 : 2);
+        x.push_back(a);
+        x.push_back(b);
+        y.push_back(labels[c]);
+        for (int k = 0; k < 3; ++k) oneHot.push_back(k == c ? 1.0f : 0.0f);
+    }
+
+    auto xgb = XGBoostBuilder().setNEstimators(10).setLearningRate(0.5f).setMaxDepth(3).setIsClassification(true).build();
+    xgb->fit(x, {"a", "b"}, y);
+    EXPECT_EQ(xgb->getNClasses(), 3);
+    EXPECT_EQ(xgb->getBestIteration(), 10);
+
+    const MatrixView view(x.data(), 150, 2);
+    const std::vector<float> predictions = xgb->predict(x, {"a", "b"});
+    const std::vector<float> proba = xgb->predictProba(view);
+    ASSERT_EQ(proba.size(), 150u * 3);
+    for (std::size_t i = 0; i < 150; ++i) {
+        const float* p = &proba[i * 3];
+        EXPECT_NEAR(p[0] + p[1] + p[2], 1.0f, 1e-5f);
+        EXPECT_EQ(predictions[i], labels[std::max_element(p, p + 3) - p]);
+        EXPECT_EQ(predictions[i], y[i]);
+    }
+
+    // one-hot targets train on the class ids 0, 1, 2
+    xgb->fit(x, {"a", "b"}, oneHot);
+    EXPECT_EQ(xgb->getNClasses(), 3);
+    EXPECT_EQ(xgb->predict(std::vector<double>{90.0, 3.0}), 2.0);
+}
+
+TEST_F(XGBoostModelTest, Subsample_MaskedRowsAndOutOfSampleUpdates) {
+    // distinct x and y, unregularized, learning rate 1: every tree puts each of its sampled rows in its own leaf and
+    // moves it exactly onto its target, out-of-sample rows get some other row's step through the batch traversal
+    const int rows = 64;
+    std::vector<std::vector<double>> X;
+    std::vector<double> Y;
+    for (int i = 0; i < rows; ++i) {
+        X.push_back({static_cast<double>(i)});
+        Y.push_back((i * 37) % rows + 0.5);
+    }
+    const std::size_t perRound = static_cast<std::size_t>(std::ceil(0.25 * rows));
+    auto onTarget = [&](const XGBoostModel64& model) {
+        std::size_t hits = 0;
+        for (int i = 0; i < rows; ++i) hits += std::fabs(model.predict(X[i]) - Y[i]) < 1e-6;
+        return hits;
+    };
+
+    // one round: exactly the sampled quarter of the rows is fitted
+    XGBoostModel64 single(1, 1.0f, 16, 0.25f, 0.0f, "None");
+    single.fit(X, Y);
+    EXPECT_EQ(onTarget(single), perRound);
+
+    // the second round's rows land on their targets only if the first round also stepped the rows it left out
+    XGBoostModel64 twice(2, 1.0f, 16, 0.25f, 0.0f, "None");
+    twice.fit(X, Y);
+    EXPECT_GE(onTarget(twice), perRound);
+    EXPECT_LE(onTarget(twice), 2 * perRound);
+
+    // the mask is redrawn from the same seed, so refits match
+    XGBoostModel64 again(2, 1.0f, 16, 0.25f, 0.0f, "None");
+    again.fit(X, Y);
+    for (const auto& row : X) EXPECT_EQ(again.predict(row), twice.predict(row));
+}